@@ -0,0 +1,9 @@
+#include "Bench.hpp"
+
+int main() {
+  bench::runPageCacheBench();
+  bench::runModuleListBench();
+  bench::runPointerFilterBench();
+  bench::runRipReferenceIndexBench();
+  return 0;
+}
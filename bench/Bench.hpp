@@ -0,0 +1,56 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <string_view>
+
+namespace bench {
+// keeps the optimizer from discarding the measured work.
+inline volatile std::uint64_t sink;
+
+// runs fn(i) for every iteration and reports the best of several
+// repetitions, which is far more stable than a single run.
+template <typename Fn>
+double measure(const std::string_view name, const std::size_t iterations,
+               Fn &&fn, const std::size_t repetitions = 5) {
+  double nsPerOp = std::numeric_limits<double>::max();
+
+  for (std::size_t r = 0; r < repetitions; r++) {
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < iterations; i++) {
+      fn(i);
+    }
+
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    nsPerOp =
+        std::min(nsPerOp, elapsed.count() / static_cast<double>(iterations));
+  }
+
+  std::cout << std::format("  {:<48} {:>10.2f} ns/op\n", name, nsPerOp);
+
+  return nsPerOp;
+}
+
+// splitmix64, deterministic across runs.
+inline std::uint64_t mix(std::uint64_t i) {
+  i += 0x9e3779b97f4a7c15;
+  i = (i ^ (i >> 30)) * 0xbf58476d1ce4e5b9;
+  i = (i ^ (i >> 27)) * 0x94d049bb133111eb;
+  return i ^ (i >> 31);
+}
+
+inline void section(const std::string_view name) {
+  std::cout << std::format("\n{}\n", name);
+}
+
+void runPageCacheBench();
+void runModuleListBench();
+void runPointerFilterBench();
+void runRipReferenceIndexBench();
+} // namespace bench
@@ -0,0 +1,57 @@
+#pragma once
+#include <dmadump/Dumper.hpp>
+#include <dmadump/ModuleList.hpp>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace bench {
+// Dumper over a synthetic in-memory address space, used to measure the
+// library's own overhead without any device latency in the way.
+class MemoryDumper : public dmadump::Dumper {
+public:
+  MemoryDumper(const std::uint64_t baseVA, const std::size_t size)
+      : baseVA(baseVA), memory(size),
+        moduleList(std::make_unique<dmadump::ModuleList>()) {
+    for (std::size_t i = 0; i < memory.size(); i++) {
+      memory[i] = static_cast<std::uint8_t>(i * 131 + 7);
+    }
+  }
+
+  bool loadModuleInfo() override { return true; }
+
+  dmadump::ModuleList *getModuleList() const override {
+    return moduleList.get();
+  }
+
+  bool readMemory(const std::uint64_t va, void *buffer,
+                  const std::uint32_t size,
+                  std::uint32_t *bytesRead = nullptr) override {
+    ++readCount;
+
+    if (va < baseVA || va + size > baseVA + memory.size()) {
+      return false;
+    }
+
+    std::memcpy(buffer, memory.data() + (va - baseVA), size);
+
+    if (bytesRead) {
+      *bytesRead = size;
+    }
+
+    return true;
+  }
+
+  std::uint64_t getBaseVA() const { return baseVA; }
+  std::size_t getSize() const { return memory.size(); }
+  std::size_t getReadCount() const { return readCount; }
+
+  std::vector<std::uint8_t> &getMemory() { return memory; }
+
+private:
+  std::uint64_t baseVA;
+  std::vector<std::uint8_t> memory;
+  std::unique_ptr<dmadump::ModuleList> moduleList;
+  std::size_t readCount{0};
+};
+} // namespace bench
@@ -0,0 +1,65 @@
+#include "Bench.hpp"
+#include <dmadump/ModuleList.hpp>
+#include <format>
+#include <ranges>
+#include <vector>
+
+namespace bench {
+namespace {
+constexpr std::uint64_t KernelBase = 0xfffff80000000000;
+constexpr std::size_t ModuleCount = 200;
+constexpr std::size_t AddressCount = 1 << 16;
+constexpr std::size_t Iterations = 4'000'000;
+
+// the lookup used before the range index: a scan over every module.
+const dmadump::ModuleInfo *scanModuleByAddress(const dmadump::ModuleList &list,
+                                               const std::uint64_t address) {
+  for (const auto &mod : std::views::values(list.getModuleMap())) {
+    if (mod->getImageBase() && mod->getImageSize() &&
+        address >= mod->getImageBase() &&
+        address < mod->getImageBase() + mod->getImageSize()) {
+      return mod.get();
+    }
+  }
+  return nullptr;
+}
+} // namespace
+
+void runModuleListBench() {
+  // a kernel-like map: drivers of 16 KiB to 4 MiB with small gaps between.
+  dmadump::ModuleList moduleList;
+
+  std::uint64_t base = KernelBase;
+  for (std::size_t i = 0; i < ModuleCount; i++) {
+    const auto size =
+        static_cast<std::uint32_t>((mix(i) % 1024 + 4) * 0x1000);
+
+    moduleList.addModule(dmadump::ModuleInfo(
+        std::format("driver{}.sys", i), std::format("driver{}.sys", i), base,
+        size, {}));
+
+    base += size + (mix(i + ModuleCount) % 16) * 0x1000;
+  }
+
+  // pointers that pass the global bounds check, most of them inside modules.
+  std::vector<std::uint64_t> addresses(AddressCount);
+  for (std::size_t i = 0; i < AddressCount; i++) {
+    addresses[i] = KernelBase + mix(i + 2 * ModuleCount) % (base - KernelBase);
+  }
+
+  section(std::format("module lookup by address, {} modules", ModuleCount));
+
+  measure("before: scan over the module map", Iterations,
+          [&](const std::size_t i) {
+            sink = sink + (scanModuleByAddress(
+                               moduleList,
+                               addresses[i % AddressCount]) != nullptr);
+          });
+
+  measure("after: branchless search over sorted ranges", Iterations,
+          [&](const std::size_t i) {
+            sink = sink + (moduleList.getModuleByAddress(
+                               addresses[i % AddressCount]) != nullptr);
+          });
+}
+} // namespace bench
@@ -0,0 +1,126 @@
+#include "Bench.hpp"
+#include "MemoryDumper.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace bench {
+namespace {
+constexpr std::uint64_t BaseVA = 0xfffff80000000000;
+constexpr std::size_t RegionSize = 16 * 1024 * 1024;
+constexpr std::size_t Iterations = 4'000'000;
+
+// the cache layout used before the radix index: one heap allocation per page
+// behind a hash map keyed by page VA.
+class HashPageCache {
+public:
+  explicit HashPageCache(MemoryDumper &dumper) {
+    for (std::uint64_t page = dumper.getBaseVA();
+         page < dumper.getBaseVA() + dumper.getSize(); page += 0x1000) {
+      auto &cached = pages[page];
+      cached = std::make_unique<std::uint8_t[]>(0x1000);
+      dumper.readMemory(page, cached.get(), 0x1000);
+    }
+  }
+
+  const std::uint8_t *find(const std::uint64_t page) const {
+    const auto found = pages.find(page);
+    return found != pages.end() ? found->second.get() : nullptr;
+  }
+
+  bool read(const std::uint64_t va, void *buffer, const std::uint32_t size) {
+    const std::uint64_t endVA = va + size;
+
+    std::uint32_t numBytesRead = 0;
+    for (std::uint64_t page = va & ~0xfff; page < endVA; page += 0x1000) {
+      const auto &cached = pages[page];
+      if (!cached) {
+        return false;
+      }
+
+      const std::uint32_t readOffset = std::max(va, page) - page;
+      const std::uint32_t readSize =
+          std::min<std::uint32_t>(0x1000 - readOffset, size - numBytesRead);
+
+      std::copy_n(cached.get() + readOffset, readSize,
+                  static_cast<std::uint8_t *>(buffer) + numBytesRead);
+
+      numBytesRead += readSize;
+    }
+
+    return true;
+  }
+
+private:
+  std::unordered_map<std::uint64_t, std::unique_ptr<std::uint8_t[]>> pages;
+};
+
+std::uint64_t randomOffset(const std::uint64_t i) {
+  return mix(i) % RegionSize;
+}
+} // namespace
+
+void runPageCacheBench() {
+  MemoryDumper dumper(BaseVA, RegionSize);
+  HashPageCache hashCache(dumper);
+
+  // warm the page cache so that only lookup cost is measured.
+  std::vector<std::uint8_t> image(RegionSize);
+  dumper.readMemoryCached(BaseVA, image.data(), RegionSize);
+
+  auto &pageCache = dumper.getPageCache();
+
+  section("index probe only, random pages");
+
+  measure("before: unordered_map", Iterations, [&](const std::size_t i) {
+    sink = sink + (hashCache.find((BaseVA + randomOffset(i)) & ~0xfff) !=
+                   nullptr);
+  });
+
+  measure("after: radix table", Iterations, [&](const std::size_t i) {
+    sink = sink + pageCache.contains((BaseVA + randomOffset(i)) & ~0xfff);
+  });
+
+  section("page lookup and read, random pages");
+
+  measure("before: unordered_map", Iterations, [&](const std::size_t i) {
+    const std::uint64_t va = BaseVA + randomOffset(i);
+    sink = sink + hashCache.find(va & ~0xfff)[va & 0xfff];
+  });
+
+  measure("after: radix table", Iterations, [&](const std::size_t i) {
+    const std::uint64_t va = BaseVA + randomOffset(i);
+    sink = sink + pageCache.find(va & ~0xfff)[va & 0xfff];
+  });
+
+  section("readMemoryCached, sequential 16-byte reads");
+
+  measure("before: unordered_map", Iterations, [&](const std::size_t i) {
+    std::uint8_t buffer[16];
+    hashCache.read(BaseVA + (i * 16) % RegionSize, buffer, sizeof(buffer));
+    sink = sink + buffer[0];
+  });
+
+  measure("after: radix table + last page", Iterations,
+          [&](const std::size_t i) {
+            std::uint8_t buffer[16];
+            dumper.readMemoryCached(BaseVA + (i * 16) % RegionSize, buffer,
+                                    sizeof(buffer));
+            sink = sink + buffer[0];
+          });
+
+  section("readMemoryCached, random 4-byte reads");
+
+  measure("before: unordered_map", Iterations, [&](const std::size_t i) {
+    std::uint32_t value;
+    hashCache.read(BaseVA + (randomOffset(i) & ~3ull), &value, sizeof(value));
+    sink = sink + value;
+  });
+
+  measure("after: radix table", Iterations, [&](const std::size_t i) {
+    std::uint32_t value;
+    dumper.readMemoryCached(BaseVA + (randomOffset(i) & ~3ull), &value,
+                            sizeof(value));
+    sink = sink + value;
+  });
+}
+} // namespace bench
@@ -0,0 +1,91 @@
+#include "Bench.hpp"
+#include <dmadump/PointerFilter.hpp>
+#include <format>
+#include <vector>
+
+namespace bench {
+namespace {
+constexpr std::uint64_t KernelBase = 0xfffff80000000000;
+constexpr std::uint64_t ModuleSpan = 0x10000000;
+constexpr std::size_t SectionSize = 16 * 1024 * 1024;
+constexpr std::size_t Iterations = 20;
+
+std::string_view getKernelName(const dmadump::PointerFilter::Kernel kernel) {
+  switch (kernel) {
+  case dmadump::PointerFilter::Kernel::AVX2:
+    return "avx2";
+  case dmadump::PointerFilter::Kernel::SSE2:
+    return "sse2";
+  default:
+    return "scalar";
+  }
+}
+} // namespace
+
+void runPointerFilterBench() {
+  // a data section of mostly zeros, small integers and heap pointers, with
+  // about one qword in 64 pointing into the module range.
+  std::vector<std::uint64_t> qwords(SectionSize / sizeof(std::uint64_t));
+  for (std::size_t i = 0; i < qwords.size(); i++) {
+    const auto r = mix(i);
+    switch (r % 64) {
+    case 0:
+      qwords[i] = KernelBase + (r >> 8) % ModuleSpan;
+      break;
+    case 1:
+    case 2:
+    case 3:
+      qwords[i] = 0xffffa00000000000 + ((r >> 8) & 0xffffffff0);
+      break;
+    default:
+      qwords[i] = r % 4 == 0 ? 0 : (r >> 40);
+      break;
+    }
+  }
+
+  section(std::format("candidate pointer filter, {} MiB data section",
+                      SectionSize / (1024 * 1024)));
+
+  std::vector<std::uint32_t> candidates;
+  candidates.reserve(qwords.size() / 32);
+
+  // the loop used before the filter, one qword and two branches at a time.
+  const double scalarNs =
+      measure("before: per-qword bounds check", Iterations, [&](std::size_t) {
+        candidates.clear();
+        for (std::size_t i = 0; i < qwords.size(); i++) {
+          if (qwords[i] >= KernelBase && qwords[i] < KernelBase + ModuleSpan) {
+            candidates.push_back(static_cast<std::uint32_t>(i));
+          }
+        }
+        sink = sink + candidates.size();
+      });
+
+  std::cout << std::format("  {:<48} {:>10.2f} GB/s\n", "",
+                           SectionSize / scalarNs);
+
+  for (const auto kernel :
+       {dmadump::PointerFilter::Kernel::Scalar,
+        dmadump::PointerFilter::Kernel::SSE2,
+        dmadump::PointerFilter::Kernel::AVX2}) {
+
+    if (!dmadump::PointerFilter::isSupported(kernel)) {
+      continue;
+    }
+
+    const dmadump::PointerFilter filter(KernelBase, KernelBase + ModuleSpan,
+                                        kernel);
+
+    const double ns =
+        measure(std::format("after: {} kernel", getKernelName(kernel)),
+                Iterations, [&](std::size_t) {
+                  candidates.clear();
+                  filter.filter(qwords, candidates);
+                  sink = sink + candidates.size();
+                });
+
+    std::cout << std::format("  {:<48} {:>10.2f} GB/s\n", "",
+                             SectionSize / ns);
+  }
+}
+} // namespace bench
@@ -0,0 +1,79 @@
+#include "Bench.hpp"
+#include <dmadump/RipReferenceIndex.hpp>
+#include <cstring>
+#include <format>
+#include <vector>
+
+namespace bench {
+namespace {
+constexpr std::size_t CodeSize = 4 * 1024 * 1024;
+constexpr std::uint32_t CodeRVA = 0x1000;
+constexpr std::uint32_t PointerRVA = CodeRVA + CodeSize;
+constexpr std::size_t ImportCount = 200;
+constexpr std::size_t CallCount = 20000;
+
+// the search used before the index: one pass over the code per pointer,
+// for calls only.
+std::size_t scanCalls(const std::vector<std::uint8_t> &code,
+                      const std::uint32_t functionPtrRVA) {
+  std::size_t count = 0;
+
+  for (std::size_t i = 0; i + 6 <= code.size(); i++) {
+    if (code[i] == 0xff && code[i + 1] == 0x15) {
+      std::int32_t displacement;
+      std::memcpy(&displacement, &code[i + 2], sizeof(displacement));
+
+      if (CodeRVA + i + 6 + displacement == functionPtrRVA) {
+        ++count;
+      }
+    }
+  }
+
+  return count;
+}
+} // namespace
+
+void runRipReferenceIndexBench() {
+  // random bytes with calls through the import pointers sprinkled in.
+  std::vector<std::uint8_t> code(CodeSize);
+  for (std::size_t i = 0; i < code.size(); i++) {
+    code[i] = static_cast<std::uint8_t>(mix(i));
+  }
+
+  for (std::size_t i = 0; i < CallCount; i++) {
+    const std::size_t offset = mix(i + CodeSize) % (CodeSize - 6);
+    const auto target =
+        static_cast<std::uint32_t>(PointerRVA + (mix(i) % ImportCount) * 8);
+    const auto displacement =
+        static_cast<std::int32_t>(target - (CodeRVA + offset + 6));
+
+    code[offset] = 0xff;
+    code[offset + 1] = 0x15;
+    std::memcpy(&code[offset + 2], &displacement, sizeof(displacement));
+  }
+
+  section(std::format("call sites of {} imports, {} MiB of code", ImportCount,
+                      CodeSize / (1024 * 1024)));
+
+  measure(
+      "before: one scan per import", 1,
+      [&](std::size_t) {
+        for (std::size_t i = 0; i < ImportCount; i++) {
+          sink = sink + scanCalls(code, PointerRVA + i * 8);
+        }
+      },
+      3);
+
+  measure(
+      "after: one pass for all kinds, then lookups", 1,
+      [&](std::size_t) {
+        dmadump::RipReferenceIndex index;
+        index.addCode(code, CodeRVA);
+
+        for (std::size_t i = 0; i < ImportCount; i++) {
+          sink = sink + index.find(PointerRVA + i * 8).size();
+        }
+      },
+      3);
+}
+} // namespace bench
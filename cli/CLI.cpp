@@ -1,6 +1,7 @@
 #include "CLI.hpp"
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 #include <dmadump/Logging.hpp>
 #include <dmadump/Utils.hpp>
 #include <dmadump/IATBuilder.hpp>
@@ -34,6 +35,25 @@ int CLI::run(const int argc, const char *const argv[]) {
     return 1;
   }
 
+  if (cacheSize) {
+    dumper->getPageCache().setCapacity(*cacheSize);
+  }
+
+  if (workerCount > 1) {
+    dumper->setConcurrentCache(true);
+    dumper->setWorkerCount(workerCount);
+  }
+
+  if (exportCachePath) {
+    exportCache = std::make_shared<ExportCache>();
+    if (!exportCache->load(*exportCachePath) &&
+        std::filesystem::exists(*exportCachePath)) {
+      LOG_WARN("ignoring invalid export cache {}.", exportCachePath->string());
+    }
+
+    dumper->setExportCache(exportCache);
+  }
+
   if (!dumpModule()) {
     return false;
   }
@@ -54,6 +74,10 @@ bool CLI::parseOptions(const int argc, const char *const argv[]) {
       ("method", "memory acquisition method (VMM)", cxxopts::value<std::string>())
 #endif
       ("iat", "type of IAT obfuscation to target", cxxopts::value<std::vector<std::string>>())
+      ("iat-scan", "where dynamic IAT slots are searched: full or reloc", cxxopts::value<std::string>()->default_value("full"))
+      ("cache-size", "page cache budget in MiB", cxxopts::value<std::size_t>())
+      ("workers", "number of threads loading module exports", cxxopts::value<std::size_t>())
+      ("export-cache", "file to cache module exports in between runs", cxxopts::value<std::string>())
       ("debug", "show debug output", cxxopts::value<bool>());
   // clang-format on
 
@@ -73,6 +97,11 @@ bool CLI::parseOptions(const int argc, const char *const argv[]) {
       }
     }
 
+    iatScan = options["iat-scan"].as<std::string>();
+    if (iatScan != "full" && iatScan != "reloc") {
+      throw std::invalid_argument("invalid --iat-scan mode " + iatScan);
+    }
+
 #ifdef _WIN32
     method =
         options["method"].count() ? options["method"].as<std::string>() : "";
@@ -81,6 +110,19 @@ bool CLI::parseOptions(const int argc, const char *const argv[]) {
         options["method"].count() ? options["method"].as<std::string>() : "fpga";
 #endif
 
+    if (options["cache-size"].count()) {
+      cacheSize = options["cache-size"].as<std::size_t>() * 1024 * 1024;
+    }
+
+    if (options["workers"].count()) {
+      workerCount =
+          std::max<std::size_t>(options["workers"].as<std::size_t>(), 1);
+    }
+
+    if (options["export-cache"].count()) {
+      exportCachePath = options["export-cache"].as<std::string>();
+    }
+
     debugMode = options["debug"].count() != 0;
 
   } catch (const std::exception &e) {
@@ -206,8 +248,9 @@ bool CLI::dumpModule() const {
 
   std::vector<std::uint8_t> moduleData(moduleInfo->getImageSize());
 
+  // the image is only read once, so keep it out of the page cache.
   std::uint32_t bytesRead = 0;
-  dumper->readMemoryCached(moduleInfo->getImageBase(), moduleData.data(),
+  dumper->readMemoryDirect(moduleInfo->getImageBase(), moduleData.data(),
                            moduleData.size(), &bytesRead);
 
   moduleData.resize(bytesRead);
@@ -233,7 +276,10 @@ bool CLI::dumpModule() const {
     IATBuilder iatBuilder(*dumper, moduleInfo);
 
     if (iatTargets.contains("dynamic")) {
-      iatBuilder.addResolver<DynamicIATResolver>();
+      const auto resolver = iatBuilder.addResolver<DynamicIATResolver>();
+      if (iatScan == "reloc") {
+        resolver->setScanMode(DynamicIATResolver::ScanMode::Relocations);
+      }
     }
 
     if (!iatBuilder.rebuild(moduleData)) {
@@ -256,6 +302,17 @@ bool CLI::dumpModule() const {
   file.write(reinterpret_cast<const char *>(moduleData.data()),
              static_cast<std::streamsize>(moduleData.size()));
 
+  if (exportCache && exportCache->isDirty() &&
+      !exportCache->save(*exportCachePath)) {
+    LOG_WARN("failed to save export cache {}.", exportCachePath->string());
+  }
+
+  if (debugMode) {
+    const auto cacheStats = dumper->getCacheStatistics();
+    LOG_INFO("page cache: {} hits, {} misses, {} evictions.", cacheStats.Hits,
+             cacheStats.Misses, cacheStats.Evictions);
+  }
+
   LOG_SUCCESS("dump has been written to {}.", dstPath.string());
   return 0;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <set>
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <optional>
@@ -27,7 +28,12 @@ private:
   std::string moduleName;
   std::string method;
   std::set<std::string> iatTargets;
+  std::string iatScan;
+  std::optional<std::size_t> cacheSize;
+  std::size_t workerCount{1};
+  std::optional<std::filesystem::path> exportCachePath;
   bool debugMode{false};
 
   std::unique_ptr<dmadump::Dumper> dumper;
+  std::shared_ptr<dmadump::ExportCache> exportCache;
 };
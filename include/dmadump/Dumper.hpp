@@ -1,14 +1,31 @@
 #pragma once
+#include <dmadump/ExportCache.hpp>
+#include <dmadump/MemoryView.hpp>
+#include <dmadump/PageCache.hpp>
+#include <dmadump/ReadRequest.hpp>
+#include <dmadump/SharedPageCache.hpp>
+#include <array>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace dmadump {
 class ModuleList;
 class ModuleInfo;
+class ModuleExportInfo;
 
 class Dumper {
+  friend class ModuleInfo;
+
 public:
+  // upper bound for a single coalesced read of consecutive missing pages.
+  static constexpr std::uint32_t MaxCoalescedPages = 0x1000;
+
+  static constexpr std::uint32_t DefaultReadAheadPages = 32;
+  static constexpr std::size_t ReadAheadStreamCount = 4;
+
   virtual ~Dumper() = default;
 
   virtual bool loadModuleInfo() = 0;
@@ -18,19 +35,115 @@ public:
   virtual bool readMemory(std::uint64_t va, void *buffer, std::uint32_t size,
                           std::uint32_t *bytesRead = nullptr) = 0;
 
+  // Reads every request in one go. The default implementation falls back to
+  // issuing one readMemory call per request; backends that can submit
+  // several reads in a single transaction should override it.
+  virtual bool readMemoryBatch(std::span<ReadRequest> requests);
+
   virtual bool readMemoryCached(std::uint64_t va, void *buffer,
                                 std::uint32_t size,
                                 std::uint32_t *bytesRead = nullptr,
                                 bool forceUpdateCache = false);
 
+  virtual bool readMemoryCachedBatch(std::span<ReadRequest> requests,
+                                     bool forceUpdateCache = false);
+
+  // returns a view of the range that reads straight out of the cache. the
+  // view ends early at the first page that cannot be read.
+  virtual MemoryView viewMemory(std::uint64_t va, std::uint32_t size,
+                                bool forceUpdateCache = false);
+
+  // reads the range straight into buffer without going through the cache.
+  // bytesRead receives the size of the readable prefix.
+  virtual bool readMemoryDirect(std::uint64_t va, void *buffer,
+                                std::uint32_t size,
+                                std::uint32_t *bytesRead = nullptr);
+
+  // scans for the terminator inside the cached pages, crossing into the next
+  // page only if the string continues there.
   virtual bool readString(std::uint64_t va, std::string &readInto,
                           std::uint32_t maxRead, bool forceUpdateCache = false);
 
+  // reads one string per VA, fetching the pages they start on as one batch.
+  virtual bool readStrings(std::span<const std::uint64_t> vas,
+                           std::vector<std::string> &readInto,
+                           std::uint32_t maxRead,
+                           bool forceUpdateCache = false);
+
+  PageCache &getPageCache();
+  const PageCache &getPageCache() const;
+
+  // switches cached reads over to a sharded, thread-safe cache so that the
+  // dumper can be shared between worker threads. the single-threaded path
+  // takes no locks while this is disabled.
+  void setConcurrentCache(bool enabled);
+  bool isConcurrentCacheEnabled() const;
+
+  PageCache::Statistics getCacheStatistics() const;
+
+  // loads the exports of every module that does not have them yet, spread
+  // over the workers. more than one worker requires the concurrent cache.
+  void loadExports(std::span<const ModuleInfo *const> modules);
+
+  void setWorkerCount(std::size_t workerCount);
+  std::size_t getWorkerCount() const;
+
+  // exports of modules found in the cache are taken from it instead of being
+  // parsed, everything that is parsed is stored in it.
+  void setExportCache(std::shared_ptr<ExportCache> exportCache);
+  const std::shared_ptr<ExportCache> &getExportCache() const;
+
+  // cache misses that continue a sequential stream read up to this many
+  // pages ahead of it, 0 disables read-ahead.
+  void setReadAheadLimit(std::uint32_t pages);
+  std::uint32_t getReadAheadLimit() const;
+
 protected:
-  virtual bool loadModuleEAT(ModuleInfo &moduleInfo);
+  // reads the module's exports, ModuleInfo calls this when they are first
+  // accessed.
+  virtual bool loadModuleEAT(const ModuleInfo &moduleInfo,
+                             std::vector<ModuleExportInfo> &exports);
+
+  bool readMemoryCachedShared(std::span<ReadRequest> requests,
+                              bool forceUpdateCache);
+
+  // fetches the pages that readMemoryCachedBatch could not serve from the
+  // cache, fills them into the requests and completes their results.
+  bool readMissingPages(std::span<ReadRequest> requests,
+                        std::vector<std::uint64_t> &missingPages);
+
+  // appends the read-ahead window of every sequential stream that the sorted,
+  // unique missing pages continue. the appended pages are sorted and unique
+  // as well, and none of them is one of the missing pages.
+  void addReadAheadPages(std::vector<std::uint64_t> &pages);
+
+  // caches whichever of the pages are missing with a single batch.
+  bool prefetchPages(std::span<const std::uint64_t> pages);
+
+  // reads the sorted, unique pages into consecutive slots of pageData and
+  // returns which of them could be read. the pages from readAheadBegin on
+  // are sorted separately and read in runs of their own, which are not
+  // retried if they fail.
+  std::vector<bool>
+  fetchPages(std::span<const std::uint64_t> pages, std::uint8_t *pageData,
+             std::size_t readAheadBegin = ~std::size_t{0});
 
 protected:
-  std::unordered_map<std::uint64_t, std::unique_ptr<std::uint8_t[]>>
-      memoryCache;
+  class ReadAheadStream {
+  public:
+    std::uint64_t NextPageVA;
+    std::uint32_t Window;
+  };
+
+  PageCache pageCache;
+  std::unique_ptr<SharedPageCache> sharedPageCache;
+
+  std::size_t workerCount{1};
+  std::shared_ptr<ExportCache> exportCache;
+
+  std::uint32_t readAheadLimit{DefaultReadAheadPages};
+  std::array<ReadAheadStream, ReadAheadStreamCount> readAheadStreams{};
+  std::size_t nextReadAheadStream{0};
+  std::mutex readAheadMutex;
 };
 } // namespace dmadump
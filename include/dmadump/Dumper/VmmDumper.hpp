@@ -20,6 +20,7 @@ public:
   ModuleList *getModuleList() const override;
   bool readMemory(std::uint64_t va, void *buffer, std::uint32_t size,
                   std::uint32_t *bytesRead = nullptr) override;
+  bool readMemoryBatch(std::span<ReadRequest> requests) override;
 
   VMM_HANDLE getRawHandle() const;
 
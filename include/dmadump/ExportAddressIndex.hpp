@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace dmadump {
+class ModuleInfo;
+class ModuleExportInfo;
+
+// Maps absolute export VAs of a set of modules to the module and export they
+// belong to. The VAs are kept in one sorted array with the entries alongside,
+// and blocks of addresses are classified with interleaved branchless
+// searches that all take the same number of steps.
+class ExportAddressIndex {
+public:
+  static constexpr std::uint32_t NotFound = ~0u;
+
+  class Entry {
+  public:
+    const ModuleInfo *Module;
+    const ModuleExportInfo *Export;
+  };
+
+  ExportAddressIndex() = default;
+
+  // loads the exports of any module that does not have them yet.
+  explicit ExportAddressIndex(std::span<const ModuleInfo *const> modules);
+
+  const Entry *find(std::uint64_t va) const;
+
+  // stores the entry index for every address in results, or NotFound.
+  void findBatch(std::span<const std::uint64_t> vas,
+                 std::span<std::uint32_t> results) const;
+
+  const Entry &getEntry(std::uint32_t index) const;
+
+  std::size_t getSize() const;
+
+private:
+  static constexpr std::size_t BatchLanes = 8;
+
+private:
+  std::vector<std::uint64_t> addresses;
+  std::vector<Entry> entries;
+};
+} // namespace dmadump
@@ -0,0 +1,110 @@
+#pragma once
+#include <dmadump/ModuleExportInfo.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dmadump {
+// Export tables of previously loaded modules, persisted between runs. The
+// file is a flat little-endian image made of a header, a table of entries,
+// a table of export records and a string pool, all addressed by offsets, so
+// it is parsed in place once read and could just as well be mapped.
+class ExportCache {
+public:
+  static constexpr std::uint64_t Magic = 0x3158455044414d44; // "DMADPEX1"
+  static constexpr std::uint32_t Version = 1;
+
+  // identifies one build of a module, everything but the path comes from the
+  // PE header and the export directory header.
+  class Key {
+  public:
+    std::string Path;
+    std::uint32_t TimeDateStamp;
+    std::uint32_t SizeOfImage;
+    std::uint32_t CheckSum;
+    std::uint32_t ExportDirectoryRVA;
+    std::uint32_t NumberOfFunctions;
+    std::uint32_t NumberOfNames;
+
+    bool operator==(const Key &other) const = default;
+  };
+
+  ExportCache() = default;
+
+  ExportCache(const ExportCache &) = delete;
+  ExportCache &operator=(const ExportCache &) = delete;
+
+  // replaces the contents with the file, returns false if it is missing or
+  // not a valid cache file.
+  bool load(const std::filesystem::path &filePath);
+
+  bool save(const std::filesystem::path &filePath) const;
+
+  bool find(const Key &key, std::vector<ModuleExportInfo> &exports) const;
+
+  void store(const Key &key, const std::vector<ModuleExportInfo> &exports);
+
+  // whether anything was stored since the last load.
+  bool isDirty() const;
+
+private:
+  class FileHeader {
+  public:
+    std::uint64_t Magic;
+    std::uint32_t Version;
+    std::uint32_t EntryCount;
+    std::uint32_t ExportCount;
+    std::uint32_t StringPoolSize;
+  };
+
+  class FileEntry {
+  public:
+    std::uint32_t PathOffset;
+    std::uint32_t PathSize;
+    std::uint32_t TimeDateStamp;
+    std::uint32_t SizeOfImage;
+    std::uint32_t CheckSum;
+    std::uint32_t ExportDirectoryRVA;
+    std::uint32_t NumberOfFunctions;
+    std::uint32_t NumberOfNames;
+    std::uint32_t FirstExport;
+    std::uint32_t ExportCount;
+  };
+
+  class FileExport {
+  public:
+    std::uint32_t RVA;
+    std::uint32_t NameOffset;
+    std::uint16_t NameSize;
+    std::uint16_t Ordinal;
+  };
+
+  class KeyHash {
+  public:
+    std::size_t operator()(const Key &key) const;
+  };
+
+  const FileHeader *getHeader() const;
+  const FileEntry *getEntries() const;
+  const FileExport *getExports() const;
+  const char *getStringPool() const;
+
+  bool validate() const;
+
+  Key getKey(const FileEntry &entry) const;
+
+private:
+  mutable std::mutex mutex;
+
+  // the file as it was loaded, entries are decoded from it on demand.
+  std::vector<std::uint8_t> fileData;
+  std::unordered_map<Key, std::uint32_t, KeyHash> fileEntries;
+
+  std::unordered_map<Key, std::vector<ModuleExportInfo>, KeyHash>
+      storedEntries;
+  bool dirty{false};
+};
+} // namespace dmadump
@@ -12,6 +12,15 @@ public:
   static constexpr std::uint32_t DefaultAllowedScnAttrs =
       ~IMAGE_SCN_MEM_EXECUTE;
 
+  enum class ScanMode {
+    // every aligned qword of the matching sections.
+    Full,
+    // only the DIR64 slots of the base relocation directory, falls back to
+    // a full scan if the image has none. slots written at runtime, such as
+    // resolved GetProcAddress results, have no relocation and are missed.
+    Relocations
+  };
+
   explicit DynamicIATResolver(
       IATBuilder &iatBuilder,
       std::uint32_t requiredScnAttrs = DefaultRequiredScnAttrs,
@@ -29,9 +38,21 @@ public:
   const std::unordered_map<std::uint32_t, ResolvedImport> &
   getResolvedImportsByRVAs() const;
 
+  ScanMode getScanMode() const;
+  void setScanMode(ScanMode mode);
+
+protected:
+  bool isScannedSection(const pe::ImageSectionHeader &section) const;
+
+  // appends the RVA of every DIR64 relocation, returns false if the image
+  // has no usable relocation directory.
+  static bool findRelocatedSlots(const pe::ImageView &imageView,
+                                 std::vector<std::uint32_t> &slotRVAs);
+
 protected:
   std::uint32_t requiredScnAttrs;
   std::uint32_t allowedScnAttrs;
+  ScanMode scanMode{ScanMode::Full};
 
   std::vector<ResolvedImport> resolvedImports;
   std::unordered_map<std::uint32_t, ResolvedImport> resolvedImportsByRVAs;
@@ -1,55 +1,73 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <variant>
 #include <optional>
+#include <dmadump/IATResolver.hpp>
 #include <dmadump/ImportDirLayout.hpp>
+#include <dmadump/PE.hpp>
+#include <dmadump/StringPool.hpp>
 
 namespace dmadump {
 class Dumper;
 class ModuleInfo;
-class IATResolver;
 class SectionBuilder;
 
 class IATBuilder {
 public:
   class ImportFunction {
   public:
-    explicit ImportFunction(std::variant<std::string, std::uint16_t> name);
+    explicit ImportFunction(std::variant<InternedString, std::uint16_t> name);
 
-    static ImportFunction fromName(std::string name);
+    static ImportFunction fromName(InternedString name);
     static ImportFunction fromOrdinal(std::uint16_t ordinal);
 
-    const std::variant<std::string, std::uint16_t> &getName() const;
+    const std::variant<InternedString, std::uint16_t> &getName() const;
     const std::optional<std::uint32_t> &getRedirectStub() const;
 
     void setRedirectStub(const std::uint32_t &rva);
 
   private:
-    std::variant<std::string, std::uint16_t> name;
+    std::variant<InternedString, std::uint16_t> name;
     std::optional<std::uint32_t> redirectStubRVA;
   };
 
   class ImportLibrary {
   public:
-    explicit ImportLibrary(std::string library,
+    explicit ImportLibrary(InternedString library,
                            std::vector<ImportFunction> functions);
 
-    const std::string &getName() const;
+    const InternedString &getName() const;
     std::vector<ImportFunction> &getFunctions();
     const std::vector<ImportFunction> &getFunctions() const;
 
     const ImportFunction *getFunctionByName(std::string_view name) const;
     const ImportFunction *getFunctionByOrdinal(std::uint16_t ordinal) const;
     const ImportFunction *getFunctionByName(
-        const std::variant<std::string, std::uint16_t> &name) const;
+        const std::variant<InternedString, std::uint16_t> &name) const;
+    ImportFunction *
+    getFunctionByName(const std::variant<InternedString, std::uint16_t> &name);
 
-    void addFunction(const ImportFunction &function);
+    // returns the index of the function, which may have been added before.
+    std::uint32_t addFunction(const ImportFunction &function);
 
   private:
-    std::string library;
+    InternedString library;
     std::vector<ImportFunction> functions;
+    // index into functions by name or ordinal.
+    std::unordered_map<std::variant<InternedString, std::uint16_t>,
+                       std::uint32_t>
+        functionsByName;
+  };
+
+  // position of an import in getImports(), which is also the order of the
+  // descriptors and thunks in the rebuilt import directory.
+  class ImportSlot {
+  public:
+    std::uint32_t Library;
+    std::uint32_t Function;
   };
 
   IATBuilder(Dumper &dumper, const ModuleInfo *moduleInfo);
@@ -58,8 +76,11 @@ public:
 
   const ModuleInfo *getModuleInfo() const;
 
-  void addImport(const std::string &libraryName,
-                 const ImportFunction &function);
+  // view of the image being rebuilt, shared with the resolvers.
+  const pe::ImageView &getImageView() const;
+
+  void addImport(std::string_view libraryName, const ImportFunction &function);
+  bool addImport(const ResolvedImport &import);
 
   bool rebuild(std::vector<std::uint8_t> &image);
 
@@ -78,29 +99,70 @@ public:
 
   const ImportFunction *findImportFunction(
       std::string_view library,
-      const std::variant<std::string, std::uint16_t> &function) const;
+      const std::variant<InternedString, std::uint16_t> &function) const;
+
+  ImportFunction *findImportFunction(
+      std::string_view library,
+      const std::variant<InternedString, std::uint16_t> &function);
+
+  const ImportFunction *findImportFunction(const ResolvedImport &import) const;
+  ImportFunction *findImportFunction(const ResolvedImport &import);
+
+  std::optional<ImportSlot> findImportSlot(const ResolvedImport &import) const;
 
-  ImportFunction *
-  findImportFunction(std::string_view library,
-                     const std::variant<std::string, std::uint16_t> &function);
+  // RVA of the FirstThunk entry of an import in the rebuilt import
+  // directory, known once it has been constructed.
+  std::optional<std::uint32_t> getImportThunk(const ImportSlot &slot) const;
+  std::optional<std::uint32_t>
+  getImportThunk(const ResolvedImport &import) const;
 
 protected:
+  static constexpr std::size_t RedirectStubSize = 6;
+
+  class SectionLayout {
+  public:
+    std::uint32_t Offset;
+    std::uint32_t RVA;
+    std::uint32_t FileSize;
+  };
+
+  // where the import directory and the code section go, and the size of the
+  // image with both.
+  class RebuildLayout {
+  public:
+    SectionLayout Data;
+    SectionLayout Code;
+    std::size_t ImageSize;
+  };
+
+  // libraries are matched case-insensitively and without their extension,
+  // like compareLibraryName does.
+  static std::string getLibraryKey(std::string_view libraryName);
+
+  ImportLibrary *findImportLibrary(std::string_view libraryName);
+  const ImportLibrary *findImportLibrary(std::string_view libraryName) const;
+
+  ImportSlot addImportSlot(std::string_view libraryName,
+                           const ImportFunction &function);
+
   void addOriginalImports(const std::vector<std::uint8_t> &image);
 
   void resolveImports(const std::vector<std::uint8_t> &image);
 
-  void rebuildImportDir(std::vector<std::uint8_t> &image) const;
+  RebuildLayout planSections(std::size_t imageSize) const;
+
+  bool rebuildImportDir(std::vector<std::uint8_t> &image,
+                        SectionBuilder &section);
 
-  void applyPatches(std::vector<std::uint8_t> &image,
+  bool applyPatches(std::vector<std::uint8_t> &image, SectionBuilder &codeScn,
                     std::uint32_t origImportDirVA);
 
-  void buildRedirectStubs(const std::vector<std::uint8_t> &image,
-                          SectionBuilder &codeScn);
+  bool buildRedirectStubs(SectionBuilder &codeScn);
 
   void redirectOriginalIAT(std::vector<std::uint8_t> &image,
                            std::uint32_t origImportDirVA) const;
 
-  bool constructImportDir(SectionBuilder &dataScn) const;
+  bool constructImportDir(SectionBuilder &dataScn);
 
   static void updateHeaders(std::vector<std::uint8_t> &image);
 
@@ -108,6 +170,12 @@ protected:
   Dumper &dumper;
   const ModuleInfo *moduleInfo;
   std::vector<std::shared_ptr<IATResolver>> iatResolvers;
+  pe::ImageView imageView;
   std::vector<ImportLibrary> imports;
+  // index into imports by library key.
+  std::unordered_map<std::string, std::uint32_t> importsByLibrary;
+  std::unordered_map<ResolvedImport, ImportSlot> importsByHandle;
+  // FirstThunk RVA of every library, in the order of imports.
+  std::vector<std::uint32_t> importThunkRVAs;
 };
 } // namespace dmadump
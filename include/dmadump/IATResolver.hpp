@@ -1,15 +1,21 @@
 #pragma once
-#include <string>
+#include <dmadump/PE.hpp>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace dmadump {
 class IATBuilder;
 class SectionBuilder;
 
+// refers to export ExportIndex of ModuleList::getModuleByIndex(ModuleIndex),
+// names are only looked up once the import directory is written.
 class ResolvedImport {
 public:
-  std::string Library;
-  std::string Function;
+  std::uint32_t ModuleIndex;
+  std::uint32_t ExportIndex;
+
+  bool operator==(const ResolvedImport &) const = default;
 };
 
 class IATResolver {
@@ -22,6 +28,10 @@ public:
 
   virtual const std::vector<ResolvedImport> &getImports() const = 0;
 
+  // bytes the resolver appends to the code section in applyPatches, which
+  // is sized before any patches are applied.
+  virtual std::size_t getPatchCodeSize() const;
+
   virtual bool applyPatches(std::vector<std::uint8_t> &image,
                             SectionBuilder &codeScn) = 0;
 
@@ -29,12 +39,19 @@ protected:
   std::uint64_t getLowestModuleStartAddress() const;
   std::uint64_t getHighestModuleEndAddress() const;
 
-  static std::vector<std::uint32_t>
-  findDirectCalls(const std::uint8_t *searchBegin,
-                  const std::uint8_t *searchEnd, std::uint32_t searchRVA,
-                  std::uint32_t functionPtrRVA);
+  // the builder's view if it is of this image, a view of its own otherwise.
+  const pe::ImageView &getImageView(const std::vector<std::uint8_t> &image);
 
 protected:
   IATBuilder &iatBuilder;
+  pe::ImageView ownImageView;
 };
 } // namespace dmadump
+
+template <> struct std::hash<dmadump::ResolvedImport> {
+  std::size_t operator()(const dmadump::ResolvedImport &import) const noexcept {
+    return std::hash<std::uint64_t>{}(
+        static_cast<std::uint64_t>(import.ModuleIndex) << 32 |
+        import.ExportIndex);
+  }
+};
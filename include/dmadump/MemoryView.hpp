@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace dmadump {
+class PageCache;
+
+// Read-only view of a range of target memory that points straight into the
+// page cache. The cached pages are pinned for the lifetime of the view, and
+// pages that happen to be adjacent in the cache are merged into one segment.
+// If the range cannot be pinned the bytes are copied into storage owned by
+// the view instead.
+class MemoryView {
+public:
+  MemoryView() = default;
+
+  MemoryView(const MemoryView &) = delete;
+  MemoryView &operator=(const MemoryView &) = delete;
+
+  MemoryView(MemoryView &&other) noexcept;
+  MemoryView &operator=(MemoryView &&other) noexcept;
+
+  ~MemoryView();
+
+  std::uint64_t getVA() const;
+
+  // the number of bytes that could be read, starting at the view's VA.
+  std::uint32_t getSize() const;
+
+  bool empty() const;
+
+  const std::vector<std::span<const std::uint8_t>> &getSegments() const;
+
+  // copies part of the viewed range into buffer, returns false if it is not
+  // covered by the view.
+  bool read(std::uint32_t offset, void *buffer, std::uint32_t size) const;
+
+private:
+  friend class Dumper;
+
+  explicit MemoryView(std::uint64_t va);
+
+  void append(const std::uint8_t *data, std::uint32_t size);
+
+  void release();
+
+private:
+  std::uint64_t va{0};
+  std::uint32_t size{0};
+  std::vector<std::span<const std::uint8_t>> segments;
+  PageCache *pageCache{nullptr};
+  std::vector<std::uint64_t> pinnedPages;
+  std::unique_ptr<std::uint8_t[]> storage;
+};
+} // namespace dmadump
@@ -1,17 +1,20 @@
 #pragma once
-#include <string>
+#include <dmadump/StringPool.hpp>
+#include <cstdint>
+#include <string_view>
 
 namespace dmadump {
 class ModuleExportInfo {
 public:
-  ModuleExportInfo(std::string name, std::uint16_t ordinal, std::uint32_t rva);
+  ModuleExportInfo(std::string_view name, std::uint16_t ordinal,
+                   std::uint32_t rva);
 
-  const std::string &getName() const;
+  const InternedString &getName() const;
   std::uint16_t getOrdinal() const;
   std::uint32_t getRVA() const;
 
 private:
-  std::string name;
+  InternedString name;
   std::uint16_t ordinal{0};
   std::uint32_t rva{0};
 };
@@ -1,15 +1,31 @@
 #pragma once
 #include <dmadump/ModuleExportInfo.hpp>
+#include <atomic>
 #include <filesystem>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace dmadump {
+class Dumper;
+
 class ModuleInfo {
+  friend class ModuleList;
+
 public:
+  static constexpr std::uint32_t NoIndex = ~0u;
+
+  // if a dumper is given, the exports are read from the module's EAT through
+  // it the first time they are accessed.
   ModuleInfo(const std::string &name, const std::filesystem::path &filePath,
              std::uint64_t imageBase, std::uint32_t imageSize,
-             const std::vector<ModuleExportInfo> &exports);
+             const std::vector<ModuleExportInfo> &exports,
+             Dumper *dumper = nullptr);
+
+  ModuleInfo(const ModuleInfo &other);
+  ModuleInfo(ModuleInfo &&other) noexcept;
 
   const std::string &getName() const;
   const std::string &getLibraryID() const;
@@ -17,21 +33,46 @@ public:
   std::uint64_t getImageBase() const;
   std::uint32_t getImageSize() const;
 
+  // position of the module in the ModuleList it was added to.
+  std::uint32_t getIndex() const;
+
   const std::vector<ModuleExportInfo> &getExports() const;
 
+  // loads the exports now unless they already are, safe to call from
+  // multiple threads.
+  void loadExports() const;
+  bool areExportsLoaded() const;
+
   void addExport(const ModuleExportInfo &exportInfo);
 
+  // lookups go through indexes that are rebuilt whenever the exports change.
   const ModuleExportInfo *getExportByName(std::string_view name) const;
   const ModuleExportInfo *getExportByOrdinal(std::uint32_t ordinal) const;
   const ModuleExportInfo *getExportByVA(std::uint64_t va) const;
   const ModuleExportInfo *getExportByRVA(std::uint32_t rva) const;
 
+private:
+  static constexpr std::uint32_t NoExport = ~0u;
+
+  void buildExportIndexes() const;
+
 private:
   std::string name;
   std::string libraryID;
   std::filesystem::path filePath;
   std::uint64_t imageBase;
   std::uint32_t imageSize;
-  std::vector<ModuleExportInfo> exports;
+  std::uint32_t index{NoIndex};
+  Dumper *dumper;
+
+  mutable std::vector<ModuleExportInfo> exports;
+
+  // export indices sorted by RVA, with the RVAs alongside for the search.
+  mutable std::vector<std::uint32_t> exportsByRVA;
+  mutable std::vector<std::uint32_t> exportRVAs;
+  mutable std::unordered_map<std::string_view, std::uint32_t> exportsByName;
+  mutable std::vector<std::uint32_t> exportsByOrdinal;
+  mutable std::atomic<bool> exportsLoaded;
+  mutable std::mutex exportsMutex;
 };
 } // namespace dmadump
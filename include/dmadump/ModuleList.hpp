@@ -4,6 +4,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace dmadump {
 class ModuleList {
@@ -17,9 +18,30 @@ public:
   getModuleMap() const;
 
   const ModuleInfo *getModuleByName(std::string_view moduleName) const;
+
+  // modules in the order they were added, see ModuleInfo::getIndex.
+  const ModuleInfo *getModuleByIndex(std::uint32_t index) const;
+  std::uint32_t getModuleCount() const;
+
+  // binary search over the module ranges, which are kept sorted by base.
+  // if ranges overlap, the containing module with the highest base wins.
   const ModuleInfo *getModuleByAddress(std::uint64_t address) const;
 
+private:
+  void addModuleEntry(ModuleInfo *moduleInfo);
+
 private:
   std::unordered_map<std::string, std::unique_ptr<ModuleInfo>> moduleMap;
+  std::vector<const ModuleInfo *> modules;
+
+  // [begin, end) of every module with a known range, sorted by begin and
+  // split into separate arrays so that the search only touches the begins.
+  std::vector<std::uint64_t> rangeBegins;
+  std::vector<std::uint64_t> rangeEnds;
+  std::vector<const ModuleInfo *> rangeModules;
+
+  // highest end of the ranges up to each index, so that overlapping ranges
+  // that begin further down can still be found.
+  std::vector<std::uint64_t> rangeMaxEnds;
 };
 } // namespace dmadump
@@ -2,6 +2,8 @@
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <span>
+#include <vector>
 
 namespace dmadump::pe {
 #define IMAGE_SIZEOF_SHORT_NAME 8
@@ -65,6 +67,10 @@ namespace dmadump::pe {
 #define IMAGE_DIRECTORY_ENTRY_DELAY_IMPORT 13
 #define IMAGE_DIRECTORY_ENTRY_COM_DESCRIPTOR 14
 
+#define IMAGE_REL_BASED_ABSOLUTE 0
+#define IMAGE_REL_BASED_HIGHLOW 3
+#define IMAGE_REL_BASED_DIR64 10
+
 #define IMAGE_ORDINAL_FLAG64 0x8000000000000000
 #define IMAGE_ORDINAL_FLAG32 0x80000000
 #define IMAGE_ORDINAL64(Ordinal) (Ordinal & 0xffff)
@@ -272,6 +278,11 @@ struct ImageImportByName {
   char Name[1];
 };
 
+struct ImageBaseRelocation {
+  std::uint32_t VirtualAddress;
+  std::uint32_t SizeOfBlock;
+};
+
 struct ImageExportDirectory {
   std::uint32_t Characteristics;
   std::uint32_t TimeDateStamp;
@@ -298,4 +309,50 @@ const ImageOptionalHeader32 *getOptionalHeader32(const void *imageData);
 ImageOptionalHeader64 *getOptionalHeader64(void *imageData);
 const ImageOptionalHeader64 *getOptionalHeader64(const void *imageData);
 
+// The headers of a 64-bit image located once, with the section ranges sorted
+// by RVA and by file offset so that converting between the two is a binary
+// search. It points into the image data, so it has to be rebuilt whenever
+// that moves or gains sections.
+class ImageView {
+public:
+  ImageView() = default;
+  explicit ImageView(std::span<const std::uint8_t> data);
+
+  std::span<const std::uint8_t> getData() const;
+  const ImageNtHeaders *getNtHeaders() const;
+  const ImageOptionalHeader64 *getOptionalHeader() const;
+  std::span<const ImageSectionHeader> getSections() const;
+
+  // the same results as the ImageNtHeaders conversions.
+  std::optional<std::uint32_t> rvaToFileOffset(std::uint32_t rva) const;
+  std::optional<std::uint32_t> fileOffsetToRVA(std::uint32_t fileOffset) const;
+
+private:
+  class SectionRange {
+  public:
+    std::uint32_t Begin;
+    // 64 bits wide, so that a section running past 4 GiB does not wrap.
+    std::uint64_t End;
+    std::uint32_t Target;
+  };
+
+  static std::vector<SectionRange> buildRanges(std::vector<SectionRange> ranges,
+                                               bool &overlapping);
+
+  static std::optional<std::uint32_t>
+  findInRanges(const std::vector<SectionRange> &ranges, std::uint32_t value);
+
+private:
+  std::span<const std::uint8_t> data;
+  const ImageNtHeaders *ntHeaders{nullptr};
+  std::span<const ImageSectionHeader> sections;
+
+  std::vector<SectionRange> rvaRanges;
+  std::vector<SectionRange> fileOffsetRanges;
+
+  // overlapping sections resolve to the first one in header order, which
+  // only the linear search over the headers reproduces.
+  bool overlappingRVAs{false};
+  bool overlappingFileOffsets{false};
+};
 } // namespace dmadump::pe
@@ -0,0 +1,106 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dmadump {
+// Fixed-budget cache of 4 KiB pages. Frames are carved out of large slabs
+// and recycled with the CLOCK algorithm once the budget is exhausted.
+// Pages are indexed by a sparse four-level radix table over VA bits 47..12,
+// shaped like the x64 paging structures, so a lookup is a handful of array
+// dereferences with no hashing.
+class PageCache {
+public:
+  static constexpr std::uint32_t PageSize = 0x1000;
+  static constexpr std::uint32_t FramesPerSlab = 256;
+  static constexpr std::size_t DefaultCapacity = 256 * 1024 * 1024;
+
+  class Statistics {
+  public:
+    std::uint64_t Hits;
+    std::uint64_t Misses;
+    std::uint64_t Evictions;
+  };
+
+  explicit PageCache(std::size_t capacity = DefaultCapacity);
+
+  PageCache(const PageCache &) = delete;
+  PageCache &operator=(const PageCache &) = delete;
+
+  // returns the cached page and marks it as referenced, or nullptr if the
+  // page is not cached. the pointer stays valid until the next insert.
+  const std::uint8_t *find(std::uint64_t pageVA);
+
+  bool contains(std::uint64_t pageVA) const;
+
+  // returns a frame for the page, evicting a page that has not been
+  // referenced recently if the budget is exhausted. the frame keeps its old
+  // contents if the page was already cached. returns nullptr if every frame
+  // is pinned.
+  std::uint8_t *insert(std::uint64_t pageVA);
+
+  // keeps a cached page from being evicted until it is unpinned, returns
+  // nullptr if the page is not cached. pins are counted.
+  const std::uint8_t *pin(std::uint64_t pageVA);
+  void unpin(std::uint64_t pageVA);
+
+  // drops every page and resets the statistics, must not be called while
+  // pages are pinned.
+  void clear();
+
+  std::size_t getCapacity() const;
+  void setCapacity(std::size_t capacity);
+
+  std::size_t getSize() const;
+  std::size_t getPinnedSize() const;
+
+  const Statistics &getStatistics() const;
+
+private:
+  static constexpr std::uint32_t InvalidFrame = ~0u;
+
+  class Frame {
+  public:
+    std::uint64_t PageVA;
+    bool Referenced;
+    std::uint32_t PinCount;
+  };
+
+  template <typename Entry> class IndexTable {
+  public:
+    std::array<Entry, 512> Entries{};
+  };
+
+  // leaf entries hold the frame index plus one in the low half, zero marks
+  // an empty slot. the high half holds VA bits 63..48 so that non-canonical
+  // aliases of a page are told apart without touching the frame.
+  using PageTable = IndexTable<std::uint64_t>;
+  using PageDirectory = IndexTable<std::unique_ptr<PageTable>>;
+  using PageDirectoryPointerTable = IndexTable<std::unique_ptr<PageDirectory>>;
+  using PageMapLevel4 = IndexTable<std::unique_ptr<PageDirectoryPointerTable>>;
+
+  static std::uint64_t makeIndexEntry(std::uint64_t pageVA,
+                                      std::uint32_t frame);
+
+  std::uint64_t *findIndexEntry(std::uint64_t pageVA) const;
+  std::uint64_t &getIndexEntry(std::uint64_t pageVA);
+
+  std::uint32_t findFrame(std::uint64_t pageVA) const;
+
+  std::uint8_t *getFrameData(std::uint32_t frame) const;
+
+  std::uint32_t allocateFrame();
+
+private:
+  std::size_t maxFrames;
+  std::vector<std::unique_ptr<std::uint8_t[]>> slabs;
+  std::vector<Frame> frames;
+  PageMapLevel4 index;
+  std::uint64_t lastPageVA{0};
+  std::uint32_t lastFrame{InvalidFrame};
+  std::uint32_t clockHand{0};
+  std::size_t pinnedFrames{0};
+  Statistics statistics{};
+};
+} // namespace dmadump
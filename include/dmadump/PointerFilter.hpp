@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace dmadump {
+// Finds the qwords of a buffer that lie inside [low, high). Scanning a data
+// section for module pointers rejects almost every qword on this check
+// alone, so it runs over several qwords at once with the widest kernel the
+// CPU supports, and only the offsets that pass are handed on.
+class PointerFilter {
+public:
+  enum class Kernel { Scalar, SSE2, AVX2 };
+
+  PointerFilter(std::uint64_t low, std::uint64_t high);
+  PointerFilter(std::uint64_t low, std::uint64_t high, Kernel kernel);
+
+  // appends the index of every qword inside the range to candidates.
+  void filter(std::span<const std::uint64_t> qwords,
+              std::vector<std::uint32_t> &candidates) const;
+
+  bool contains(std::uint64_t qword) const;
+
+  Kernel getKernel() const;
+
+  // the widest kernel that this CPU and OS support.
+  static Kernel getBestKernel();
+
+  static bool isSupported(Kernel kernel);
+
+private:
+  void filterScalar(std::span<const std::uint64_t> qwords, std::size_t begin,
+                    std::vector<std::uint32_t> &candidates) const;
+  void filterSSE2(std::span<const std::uint64_t> qwords,
+                  std::vector<std::uint32_t> &candidates) const;
+  void filterAVX2(std::span<const std::uint64_t> qwords,
+                  std::vector<std::uint32_t> &candidates) const;
+
+private:
+  std::uint64_t low;
+  // high - low, or 0 for an empty range, so that a single unsigned compare
+  // of qword - low checks both bounds.
+  std::uint64_t width;
+  Kernel kernel;
+};
+} // namespace dmadump
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+namespace dmadump {
+class ReadRequest {
+public:
+  std::uint64_t VA;
+  void *Buffer;
+  std::uint32_t Size;
+  std::uint32_t BytesRead;
+  bool Success;
+};
+} // namespace dmadump
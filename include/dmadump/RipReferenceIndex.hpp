@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace dmadump {
+enum class RipReferenceKind : std::uint8_t {
+  // call qword ptr [rip+disp32], FF 15
+  Call,
+  // jmp qword ptr [rip+disp32], FF 25
+  Jump,
+  // mov r64, qword ptr [rip+disp32], REX.W 8B /r
+  Load,
+  // lea r64, [rip+disp32], REX.W 8D /r
+  Address
+};
+
+class RipReference {
+public:
+  std::uint32_t SiteRVA;
+  std::uint32_t TargetRVA;
+  RipReferenceKind Kind;
+  // where the disp32 starts and where the instruction ends, relative to the
+  // site.
+  std::uint8_t DisplacementOffset;
+  std::uint8_t Length;
+};
+
+// Maps the RVA that every RIP-relative call, jmp, mov or lea of some code
+// refers to to the instructions doing so. All kinds are found in one pass
+// per added code range, driven by a table of the lead bytes and ModRM bytes
+// involved.
+class RipReferenceIndex {
+public:
+  void addCode(std::span<const std::uint8_t> code, std::uint32_t codeRVA);
+
+  // the references to targetRVA in ascending order of their site.
+  std::span<const RipReference> find(std::uint32_t targetRVA) const;
+
+  std::size_t getSize() const;
+
+private:
+  // sorted by target, then by site.
+  std::vector<RipReference> references;
+};
+} // namespace dmadump
@@ -1,12 +1,18 @@
 #pragma once
-#include <vector>
+#include <cstdint>
+#include <span>
+#include <type_traits>
 
 namespace dmadump {
+// Writes a section straight into storage that was sized for it up front,
+// usually the tail of the image it is added to.
 class SectionBuilder {
 public:
   SectionBuilder(std::uint32_t sectionOffset, std::uint32_t sectionRVA,
-                 std::uint32_t sectionAlignment, std::uint32_t fileAlignment);
+                 std::uint32_t sectionAlignment, std::uint32_t fileAlignment,
+                 std::span<std::uint8_t> storage);
 
+  // zeroes the padding up to the file size.
   void finalize();
 
   std::uint32_t getOffset() const;
@@ -15,22 +21,29 @@ public:
   std::uint32_t getSectionAlignment() const;
   std::uint32_t getFileAlignment() const;
 
-  const std::vector<std::uint8_t> &getData() const;
-  std::vector<std::uint8_t> &getMutableData();
+  // the bytes written so far.
+  std::span<const std::uint8_t> getData() const;
+  std::span<std::uint8_t> getMutableData();
 
-  void append(const std::uint8_t *buffer, std::size_t size);
+  // claims the next size bytes, or returns nullptr if the storage has no
+  // room left for them.
+  std::uint8_t *reserve(std::size_t size);
+
+  bool append(const std::uint8_t *buffer, std::size_t size);
 
   template <typename Container>
-    requires std::input_iterator<typename Container::const_iterator>
-  inline void append(const Container &container) {
-    data.insert(data.end(), container.begin(), container.end());
+    requires std::is_trivially_copyable_v<typename Container::value_type>
+  inline bool append(const Container &container) {
+    return append(reinterpret_cast<const std::uint8_t *>(std::data(container)),
+                  std::size(container) *
+                      sizeof(typename Container::value_type));
   }
 
   template <typename T>
     requires std::is_trivially_copyable_v<T>
-  inline void append(const T &value) {
-    data.insert(data.end(), reinterpret_cast<const std::uint8_t *>(&value),
-                reinterpret_cast<const std::uint8_t *>(&value + 1));
+  inline bool append(const T &value) {
+    return append(reinterpret_cast<const std::uint8_t *>(&value),
+                  sizeof(value));
   }
 
   std::uint32_t getRawSize() const;
@@ -49,6 +62,7 @@ protected:
 
   std::uint32_t characteristics;
 
-  std::vector<std::uint8_t> data;
+  std::span<std::uint8_t> storage;
+  std::size_t size;
 };
 } // namespace dmadump
@@ -0,0 +1,71 @@
+#pragma once
+#include <dmadump/PageCache.hpp>
+#include <array>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
+namespace dmadump {
+// Thread-safe page cache for sharing one Dumper between workers. Pages are
+// spread over independently locked PageCache shards by page number, and
+// pages that are already being fetched by one thread are handed to other
+// threads missing them instead of being read a second time.
+class SharedPageCache {
+public:
+  static constexpr std::size_t ShardCount = 16;
+
+  class Claim {
+  public:
+    // the caller has to fetch the page and publish it.
+    bool Owner;
+    // valid if another thread is fetching the page; resolves to whether
+    // that fetch succeeded.
+    std::shared_future<bool> Pending;
+  };
+
+  explicit SharedPageCache(std::size_t capacity = PageCache::DefaultCapacity);
+
+  // copies part of a cached page into buffer, returns false if the page is
+  // not cached.
+  bool read(std::uint64_t pageVA, std::uint32_t offset, std::uint32_t size,
+            void *buffer);
+
+  bool contains(std::uint64_t pageVA) const;
+
+  // claims the page for fetching unless it is already being fetched, or
+  // cached and forceUpdate is not set.
+  Claim claim(std::uint64_t pageVA, bool forceUpdate = false);
+
+  // stores a claimed page, or drops the claim if data is nullptr, and wakes
+  // every thread waiting on it.
+  void publish(std::uint64_t pageVA, const std::uint8_t *data);
+
+  void clear();
+
+  std::size_t getCapacity() const;
+
+  PageCache::Statistics getStatistics() const;
+
+private:
+  class InFlight {
+  public:
+    std::promise<bool> Promise;
+    std::shared_future<bool> Future;
+  };
+
+  class Shard {
+  public:
+    explicit Shard(std::size_t capacity);
+
+    mutable std::mutex Mutex;
+    PageCache Cache;
+    std::unordered_map<std::uint64_t, InFlight> Pending;
+  };
+
+  Shard &getShard(std::uint64_t pageVA) const;
+
+private:
+  std::size_t capacity;
+  std::array<std::unique_ptr<Shard>, ShardCount> shards;
+};
+} // namespace dmadump
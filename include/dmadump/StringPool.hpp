@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace dmadump {
+// Handle to a string stored in the session-wide StringPool. Equal strings
+// share one copy, so handles compare and hash by address. The characters
+// are NUL-terminated and live until the process exits.
+class InternedString {
+public:
+  InternedString() = default;
+  explicit InternedString(std::string_view str);
+
+  std::string_view view() const { return str; }
+  operator std::string_view() const { return str; }
+
+  const char *data() const { return str.data(); }
+  std::size_t size() const { return str.size(); }
+  bool empty() const { return str.empty(); }
+
+  bool operator==(const InternedString &other) const {
+    return str.data() == other.str.data();
+  }
+
+  bool operator==(const std::string_view other) const { return str == other; }
+
+private:
+  friend class StringPool;
+
+  static constexpr char Empty[1] = "";
+
+  std::string_view str{Empty, 0};
+};
+
+class StringPool {
+public:
+  static constexpr std::size_t BlockSize = 64 * 1024;
+
+  // the pool shared by everything in the process.
+  static StringPool &get();
+
+  StringPool() = default;
+
+  StringPool(const StringPool &) = delete;
+  StringPool &operator=(const StringPool &) = delete;
+
+  InternedString intern(std::string_view str);
+
+  std::size_t getCount() const;
+  std::size_t getArenaSize() const;
+
+private:
+  std::string_view allocate(std::string_view str);
+
+private:
+  mutable std::shared_mutex mutex;
+  std::unordered_set<std::string_view> strings;
+  std::vector<std::unique_ptr<char[]>> blocks;
+  std::vector<std::unique_ptr<char[]>> largeBlocks;
+  std::size_t blockUsed{BlockSize};
+  std::size_t arenaSize{0};
+};
+} // namespace dmadump
+
+template <> struct std::hash<dmadump::InternedString> {
+  std::size_t operator()(const dmadump::InternedString &str) const {
+    return std::hash<const char *>{}(str.data());
+  }
+};
+
+template <>
+struct std::formatter<dmadump::InternedString>
+    : std::formatter<std::string_view> {
+  auto format(const dmadump::InternedString &str, auto &ctx) const {
+    return std::formatter<std::string_view>::format(str.view(), ctx);
+  }
+};
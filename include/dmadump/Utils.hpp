@@ -1,9 +1,12 @@
 #pragma once
 #include <dmadump/PE.hpp>
+#include <algorithm>
+#include <atomic>
 #include <expected>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <vector>
 #include <vmmdll.h>
@@ -16,6 +19,26 @@ static constexpr T align(T value, T alignment)
   return (value + alignment - 1) & ~(alignment - 1);
 }
 
+// calls fn(i) for every i in [0, count), spread over up to workerCount
+// threads including the calling one. indices are handed out in order.
+template <typename Fn>
+void parallelFor(const std::size_t count, const std::size_t workerCount,
+                 Fn &&fn) {
+  std::atomic<std::size_t> next{0};
+  const auto work = [&] {
+    for (std::size_t i = next++; i < count; i = next++) {
+      fn(i);
+    }
+  };
+
+  std::vector<std::jthread> workers;
+  for (std::size_t i = 1; i < std::min(workerCount, count); i++) {
+    workers.emplace_back(work);
+  }
+
+  work();
+}
+
 #ifdef _WIN32
 bool enablePrivilege(const char *privilegeName);
 #endif
@@ -1,8 +1,45 @@
 #include <dmadump/Dumper.hpp>
 #include <dmadump/ModuleInfo.hpp>
 #include <dmadump/PE.hpp>
+#include <dmadump/Utils.hpp>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 namespace dmadump {
+namespace {
+// invokes fn(pageVA, bufferOffset, pageOffset, size) for every page that the
+// request touches.
+template <typename Fn> void forEachPage(const ReadRequest &request, Fn &&fn) {
+  const std::uint64_t endVA = request.VA + request.Size;
+
+  for (std::uint64_t page = request.VA & ~0xfff; page < endVA;
+       page += PageCache::PageSize) {
+    const std::uint64_t begin = std::max(request.VA, page);
+    const std::uint64_t end = std::min(endVA, page + PageCache::PageSize);
+
+    fn(page, static_cast<std::uint32_t>(begin - request.VA),
+       static_cast<std::uint32_t>(begin - page),
+       static_cast<std::uint32_t>(end - begin));
+  }
+}
+} // namespace
+
+bool Dumper::readMemoryBatch(const std::span<ReadRequest> requests) {
+  bool result = true;
+
+  for (auto &request : requests) {
+    request.BytesRead = 0;
+    request.Success = readMemory(request.VA, request.Buffer, request.Size,
+                                 &request.BytesRead);
+    result &= request.Success;
+  }
+
+  return result;
+}
+
 bool Dumper::readMemoryCached(std::uint64_t va, void *buffer,
                               std::uint32_t size, std::uint32_t *bytesRead,
                               bool forceUpdateCache) {
@@ -10,128 +47,918 @@ bool Dumper::readMemoryCached(std::uint64_t va, void *buffer,
     return false;
   }
 
-  const std::uint64_t startPageVA = va & ~0xfff;
-  const std::uint64_t endVA = va + size;
-  const std::uint64_t endPageVA = (endVA + 0xfff) & ~0xfff;
+  ReadRequest request{va, buffer, size, 0, false};
 
-  std::size_t numBytesRead = 0;
-  for (std::uint64_t page = startPageVA; page < endPageVA; page += 0x1000) {
+  // small reads that stay within one page skip the batch bookkeeping.
+  if (!sharedPageCache && (va & 0xfff) + size <= PageCache::PageSize) {
+    const std::uint64_t page = va & ~0xfff;
 
-    auto &cached = memoryCache[page];
-    if (!cached || forceUpdateCache) {
-      auto pageData = std::make_unique<std::uint8_t[]>(0x1000);
+    if (const std::uint8_t *cached =
+            forceUpdateCache ? nullptr : pageCache.find(page)) {
+      std::copy_n(cached + (va & 0xfff), size,
+                  static_cast<std::uint8_t *>(buffer));
 
-      std::uint32_t pageBytesRead;
-      if (!readMemory(page, pageData.get(), 0x1000, &pageBytesRead)) {
-        if (bytesRead) {
-          *bytesRead = numBytesRead;
-        }
-        return false;
+      if (bytesRead) {
+        *bytesRead = size;
       }
 
-      cached = std::move(pageData);
+      return true;
     }
 
-    const std::uint32_t readOffset = std::max(va, page) - page;
-    const std::uint32_t readSize =
-        std::min<std::uint32_t>(0x1000 - readOffset, size - numBytesRead);
+    std::vector missingPages{page};
+    const bool result = readMissingPages({&request, 1}, missingPages);
 
-    std::copy_n(cached.get() + readOffset, readSize,
-                static_cast<std::uint8_t *>(buffer) + numBytesRead);
+    if (bytesRead) {
+      *bytesRead = request.BytesRead;
+    }
 
-    numBytesRead += readSize;
+    return result;
   }
 
+  const bool result = readMemoryCachedBatch({&request, 1}, forceUpdateCache);
+
   if (bytesRead) {
-    *bytesRead = numBytesRead;
+    *bytesRead = request.BytesRead;
   }
 
-  return true;
+  return result;
+}
+
+bool Dumper::readMemoryCachedBatch(const std::span<ReadRequest> requests,
+                                   const bool forceUpdateCache) {
+
+  if (sharedPageCache) {
+    return readMemoryCachedShared(requests, forceUpdateCache);
+  }
+
+  // serve everything that is already cached and collect the rest.
+  std::vector<std::uint64_t> missingPages;
+  for (auto &request : requests) {
+    request.BytesRead = 0;
+    request.Success = false;
+
+    if (request.VA == 0 || request.Size == 0) {
+      continue;
+    }
+
+    forEachPage(request, [&](const std::uint64_t page,
+                             const std::uint32_t bufferOffset,
+                             const std::uint32_t pageOffset,
+                             const std::uint32_t size) {
+      const std::uint8_t *cached =
+          forceUpdateCache ? nullptr : pageCache.find(page);
+
+      if (cached) {
+        std::copy_n(cached + pageOffset, size,
+                    static_cast<std::uint8_t *>(request.Buffer) + bufferOffset);
+      } else {
+        missingPages.push_back(page);
+      }
+    });
+  }
+
+  return readMissingPages(requests, missingPages);
+}
+
+bool Dumper::readMemoryCachedShared(const std::span<ReadRequest> requests,
+                                    const bool forceUpdateCache) {
+
+  std::vector<std::uint64_t> missingPages;
+  for (auto &request : requests) {
+    request.BytesRead = 0;
+    request.Success = false;
+
+    if (request.VA == 0 || request.Size == 0) {
+      continue;
+    }
+
+    forEachPage(request, [&](const std::uint64_t page,
+                             const std::uint32_t bufferOffset,
+                             const std::uint32_t pageOffset,
+                             const std::uint32_t size) {
+      if (forceUpdateCache ||
+          !sharedPageCache->read(page, pageOffset, size,
+                                 static_cast<std::uint8_t *>(request.Buffer) +
+                                     bufferOffset)) {
+        missingPages.push_back(page);
+      }
+    });
+  }
+
+  std::ranges::sort(missingPages);
+  const auto duplicates = std::ranges::unique(missingPages);
+  missingPages.erase(duplicates.begin(), duplicates.end());
+
+  const std::size_t requestedCount = missingPages.size();
+  addReadAheadPages(missingPages);
+
+  // claim the missing pages so that pages another thread is already fetching
+  // are waited for instead of being read a second time.
+  std::vector<SharedPageCache::Claim> claims(missingPages.size());
+  std::vector<std::uint64_t> ownedPages;
+  std::size_t ownedRequestedCount = 0;
+
+  for (std::size_t i = 0; i < missingPages.size(); i++) {
+    claims[i] = sharedPageCache->claim(missingPages[i], forceUpdateCache);
+    if (claims[i].Owner) {
+      ownedPages.push_back(missingPages[i]);
+      ownedRequestedCount += i < requestedCount;
+    }
+  }
+
+  // owned pages are published before waiting on anybody else, so two threads
+  // waiting on each other's pages cannot deadlock.
+  std::unique_ptr<std::uint8_t[]> pageData;
+  std::vector<bool> pageRead;
+  if (!ownedPages.empty()) {
+    pageData = std::make_unique_for_overwrite<std::uint8_t[]>(
+        ownedPages.size() * PageCache::PageSize);
+    pageRead = fetchPages(ownedPages, pageData.get(), ownedRequestedCount);
+
+    for (std::size_t i = 0; i < ownedPages.size(); i++) {
+      sharedPageCache->publish(ownedPages[i],
+                               pageRead[i] ? pageData.get() +
+                                                 i * PageCache::PageSize
+                                           : nullptr);
+    }
+  }
+
+  bool result = true;
+  for (auto &request : requests) {
+    if (request.VA == 0 || request.Size == 0) {
+      result = false;
+      continue;
+    }
+
+    std::optional<std::uint32_t> failedOffset;
+    if (requestedCount != 0) {
+      forEachPage(request, [&](const std::uint64_t page,
+                               const std::uint32_t bufferOffset,
+                               const std::uint32_t pageOffset,
+                               const std::uint32_t size) {
+        const auto requestedPages =
+            std::span(missingPages).first(requestedCount);
+        const auto found = std::ranges::lower_bound(requestedPages, page);
+        if (found == requestedPages.end() || *found != page) {
+          return;
+        }
+
+        const auto &claim = claims[found - requestedPages.begin()];
+        const auto destination =
+            static_cast<std::uint8_t *>(request.Buffer) + bufferOffset;
+
+        if (claim.Owner) {
+          const auto ownedRequestedPages =
+              std::span(ownedPages).first(ownedRequestedCount);
+          const std::size_t i =
+              std::ranges::lower_bound(ownedRequestedPages, page) -
+              ownedRequestedPages.begin();
+
+          if (pageRead[i]) {
+            std::copy_n(pageData.get() + i * PageCache::PageSize + pageOffset,
+                        size, destination);
+          } else {
+            failedOffset = std::min(failedOffset.value_or(bufferOffset),
+                                    bufferOffset);
+          }
+          return;
+        }
+
+        if (claim.Pending.valid()) {
+          claim.Pending.wait();
+        }
+
+        if (sharedPageCache->read(page, pageOffset, size, destination)) {
+          return;
+        }
+
+        // the other fetch failed or the page has been evicted since, read it
+        // directly rather than claiming it again.
+        std::uint8_t pageBuffer[PageCache::PageSize];
+        if (fetchPages({&page, 1}, pageBuffer)[0]) {
+          std::copy_n(pageBuffer + pageOffset, size, destination);
+        } else {
+          failedOffset =
+              std::min(failedOffset.value_or(bufferOffset), bufferOffset);
+        }
+      });
+    }
+
+    request.BytesRead = failedOffset.value_or(request.Size);
+    request.Success = request.BytesRead == request.Size;
+    result &= request.Success;
+  }
+
+  return result;
 }
 
-bool Dumper::readString(std::uint64_t va, std::string &readInto,
-                        std::uint32_t maxRead, bool forceUpdateCache) {
-  char buffer[16];
-  for (std::uint32_t totalBytesRead = 0, bytesRead = 0;
-       totalBytesRead < maxRead; totalBytesRead += bytesRead) {
+bool Dumper::readMissingPages(const std::span<ReadRequest> requests,
+                              std::vector<std::uint64_t> &missingPages) {
 
-    readMemoryCached(va + totalBytesRead, buffer, sizeof(buffer), &bytesRead,
+  std::ranges::sort(missingPages);
+  const auto duplicates = std::ranges::unique(missingPages);
+  missingPages.erase(duplicates.begin(), duplicates.end());
+
+  const std::size_t requestedCount = missingPages.size();
+  addReadAheadPages(missingPages);
+
+  std::unique_ptr<std::uint8_t[]> pageData;
+  std::vector<bool> pageRead;
+  if (!missingPages.empty()) {
+    pageData = std::make_unique_for_overwrite<std::uint8_t[]>(
+        missingPages.size() * PageCache::PageSize);
+    pageRead = fetchPages(missingPages, pageData.get(), requestedCount);
+  }
+
+  const auto requestedPages = std::span(missingPages).first(requestedCount);
+
+  bool result = true;
+  for (auto &request : requests) {
+    if (request.VA == 0 || request.Size == 0) {
+      result = false;
+      continue;
+    }
+
+    std::optional<std::uint32_t> failedOffset;
+    if (!requestedPages.empty()) {
+      forEachPage(request, [&](const std::uint64_t page,
+                               const std::uint32_t bufferOffset,
+                               const std::uint32_t pageOffset,
+                               const std::uint32_t size) {
+        const auto found = std::ranges::lower_bound(requestedPages, page);
+        if (found == requestedPages.end() || *found != page) {
+          return;
+        }
+
+        const std::size_t i = found - requestedPages.begin();
+        if (!pageRead[i]) {
+          failedOffset = std::min(failedOffset.value_or(bufferOffset),
+                                  bufferOffset);
+          return;
+        }
+
+        std::copy_n(pageData.get() + i * PageCache::PageSize + pageOffset,
+                    size,
+                    static_cast<std::uint8_t *>(request.Buffer) + bufferOffset);
+      });
+    }
+
+    request.BytesRead = failedOffset.value_or(request.Size);
+    request.Success = request.BytesRead == request.Size;
+    result &= request.Success;
+  }
+
+  for (std::size_t i = 0; i < missingPages.size(); i++) {
+    if (!pageRead[i]) {
+      continue;
+    }
+
+    // the page is only left uncached if every frame is pinned.
+    if (const auto frame = pageCache.insert(missingPages[i])) {
+      std::copy_n(pageData.get() + i * PageCache::PageSize,
+                  PageCache::PageSize, frame);
+    }
+  }
+
+  return result;
+}
+
+MemoryView Dumper::viewMemory(const std::uint64_t va, const std::uint32_t size,
+                              const bool forceUpdateCache) {
+  MemoryView view(va);
+  if (va == 0 || size == 0) {
+    return view;
+  }
+
+  const ReadRequest range{va, nullptr, size, 0, false};
+  const std::uint64_t firstPage = va & ~0xfff;
+  const std::size_t pageCount =
+      (va + size - firstPage + PageCache::PageSize - 1) / PageCache::PageSize;
+
+  // pinning needs at least one unpinned frame left over for later inserts,
+  // anything that does not fit is copied instead.
+  if (sharedPageCache ||
+      pageCount * PageCache::PageSize >=
+          pageCache.getCapacity() - pageCache.getPinnedSize()) {
+    view.storage = std::make_unique_for_overwrite<std::uint8_t[]>(size);
+
+    std::uint32_t bytesRead = 0;
+    readMemoryCached(va, view.storage.get(), size, &bytesRead,
                      forceUpdateCache);
-    if (bytesRead == 0) {
-      return totalBytesRead != 0;
+
+    if (bytesRead != 0) {
+      view.append(view.storage.get(), bytesRead);
     }
 
-    for (std::uint32_t i = 0; i < bytesRead; i++) {
-      if (buffer[i] == '\0') {
-        readInto.insert(readInto.end(), buffer, buffer + i);
-        return true;
+    return view;
+  }
+
+  // the cached pages are pinned before any missing page is inserted, so that
+  // the inserts cannot evict them.
+  std::vector<const std::uint8_t *> cachedPages;
+  std::vector<std::uint64_t> missingPages;
+  forEachPage(range, [&](const std::uint64_t page, std::uint32_t,
+                         std::uint32_t, std::uint32_t) {
+    const std::uint8_t *data = nullptr;
+    if (!forceUpdateCache && pageCache.find(page)) {
+      data = pageCache.pin(page);
+    } else {
+      missingPages.push_back(page);
+    }
+    cachedPages.push_back(data);
+  });
+
+  const auto pageData = std::make_unique_for_overwrite<std::uint8_t[]>(
+      missingPages.size() * PageCache::PageSize);
+  const auto pageRead = fetchPages(missingPages, pageData.get());
+
+  // the missing pages are pinned as soon as they are inserted, everything
+  // past the first unreadable page is unpinned again.
+  view.pageCache = &pageCache;
+
+  std::size_t pageIndex = 0;
+  std::size_t missingIndex = 0;
+  bool readable = true;
+  forEachPage(range, [&](const std::uint64_t page, std::uint32_t,
+                         const std::uint32_t pageOffset,
+                         const std::uint32_t size) {
+    const std::uint8_t *data = cachedPages[pageIndex++];
+
+    if (!data) {
+      if (!pageRead[missingIndex]) {
+        readable = false;
+      } else if (readable) {
+        // the capacity check above leaves an unpinned frame, a failed
+        // insert would only end the view early.
+        if (const auto frame = pageCache.insert(page)) {
+          std::copy_n(pageData.get() + missingIndex * PageCache::PageSize,
+                      PageCache::PageSize, frame);
+          data = pageCache.pin(page);
+        } else {
+          readable = false;
+        }
+      }
+      missingIndex++;
+    }
+
+    if (!readable) {
+      if (data) {
+        pageCache.unpin(page);
+      }
+      return;
+    }
+
+    view.pinnedPages.push_back(page);
+    view.append(data + pageOffset, size);
+  });
+
+  return view;
+}
+
+bool Dumper::readMemoryDirect(const std::uint64_t va, void *buffer,
+                              const std::uint32_t size,
+                              std::uint32_t *bytesRead) {
+  if (bytesRead) {
+    *bytesRead = 0;
+  }
+
+  if (va == 0 || size == 0) {
+    return false;
+  }
+
+  const auto dest = static_cast<std::uint8_t *>(buffer);
+
+  // split the range into chunks of the coalescing limit, all of which are
+  // submitted as one batch.
+  constexpr std::uint32_t chunkSize = MaxCoalescedPages * PageCache::PageSize;
+
+  std::vector<ReadRequest> chunks;
+  for (std::uint32_t offset = 0; offset < size; offset += chunkSize) {
+    chunks.push_back({va + offset, dest + offset,
+                      std::min(chunkSize, size - offset), 0, false});
+  }
+
+  if (readMemoryBatch(chunks)) {
+    if (bytesRead) {
+      *bytesRead = size;
+    }
+    return true;
+  }
+
+  // retry failed chunks page by page to find out how far the range can be
+  // read.
+  std::vector<std::size_t> retryChunks;
+  std::vector<ReadRequest> retryRequests;
+  for (std::size_t i = 0; i < chunks.size(); i++) {
+    if (chunks[i].Success) {
+      continue;
+    }
+
+    forEachPage(chunks[i], [&](const std::uint64_t page,
+                               const std::uint32_t bufferOffset,
+                               std::uint32_t, const std::uint32_t size) {
+      retryChunks.push_back(i);
+      retryRequests.push_back({std::max(chunks[i].VA, page),
+                               dest + (chunks[i].VA - va) + bufferOffset, size,
+                               0, false});
+    });
+  }
+
+  readMemoryBatch(retryRequests);
+
+  std::uint32_t readableSize = 0;
+  std::size_t retryIndex = 0;
+  for (std::size_t i = 0; i < chunks.size(); i++) {
+    if (chunks[i].Success) {
+      readableSize += chunks[i].Size;
+      continue;
+    }
+
+    for (; retryIndex < retryRequests.size() && retryChunks[retryIndex] == i;
+         retryIndex++) {
+      if (!retryRequests[retryIndex].Success) {
+        break;
+      }
+      readableSize += retryRequests[retryIndex].Size;
+    }
+
+    if (readableSize != chunks[i].VA - va + chunks[i].Size) {
+      break;
+    }
+  }
+
+  if (bytesRead) {
+    *bytesRead = readableSize;
+  }
+
+  return false;
+}
+
+bool Dumper::readString(const std::uint64_t va, std::string &readInto,
+                        const std::uint32_t maxRead,
+                        const bool forceUpdateCache) {
+  std::uint32_t totalBytesRead = 0;
+  while (totalBytesRead < maxRead) {
+    const std::uint64_t chunkVA = va + totalBytesRead;
+    const std::uint32_t chunkSize = std::min<std::uint32_t>(
+        maxRead - totalBytesRead, PageCache::PageSize - (chunkVA & 0xfff));
+
+    // cached pages are scanned in place, anything else goes through a view
+    // that is read and pinned for the duration of the scan.
+    const std::uint8_t *chunk = nullptr;
+    MemoryView view;
+
+    if (!sharedPageCache && !forceUpdateCache) {
+      chunk = pageCache.find(chunkVA & ~0xfff);
+      if (chunk) {
+        chunk += chunkVA & 0xfff;
       }
     }
 
-    readInto.insert(readInto.end(), buffer, buffer + sizeof(buffer));
+    if (!chunk) {
+      view = viewMemory(chunkVA, chunkSize, forceUpdateCache);
+      if (view.getSize() != chunkSize) {
+        return totalBytesRead != 0;
+      }
+
+      chunk = view.getSegments().front().data();
+    }
+
+    if (const auto terminator = std::memchr(chunk, '\0', chunkSize)) {
+      readInto.append(reinterpret_cast<const char *>(chunk),
+                      static_cast<const std::uint8_t *>(terminator) - chunk);
+      return true;
+    }
+
+    readInto.append(reinterpret_cast<const char *>(chunk), chunkSize);
+    totalBytesRead += chunkSize;
   }
 
   return true;
 }
 
-bool Dumper::loadModuleEAT(ModuleInfo &moduleInfo) {
+bool Dumper::readStrings(const std::span<const std::uint64_t> vas,
+                         std::vector<std::string> &readInto,
+                         const std::uint32_t maxRead,
+                         const bool forceUpdateCache) {
+  readInto.resize(vas.size());
+
+  // bring in the first page of every string with a single batch, strings
+  // that continue on the next page pick it up as they go.
+  if (!forceUpdateCache) {
+    std::vector<std::uint64_t> pages;
+    pages.reserve(vas.size());
+
+    for (const auto va : vas) {
+      if (va != 0) {
+        pages.push_back(va & ~0xfff);
+      }
+    }
+
+    std::ranges::sort(pages);
+    const auto duplicates = std::ranges::unique(pages);
+    pages.erase(duplicates.begin(), duplicates.end());
+
+    prefetchPages(pages);
+  }
+
+  bool result = true;
+  for (std::size_t i = 0; i < vas.size(); i++) {
+    readInto[i].clear();
+    result &= readString(vas[i], readInto[i], maxRead, forceUpdateCache);
+  }
+
+  return result;
+}
+
+PageCache &Dumper::getPageCache() { return pageCache; }
+
+const PageCache &Dumper::getPageCache() const { return pageCache; }
+
+void Dumper::setConcurrentCache(const bool enabled) {
+  if (enabled && !sharedPageCache) {
+    // the budget covers whichever cache is active.
+    sharedPageCache =
+        std::make_unique<SharedPageCache>(pageCache.getCapacity());
+    pageCache.clear();
+  } else if (!enabled) {
+    sharedPageCache.reset();
+  }
+}
+
+bool Dumper::isConcurrentCacheEnabled() const {
+  return sharedPageCache != nullptr;
+}
+
+PageCache::Statistics Dumper::getCacheStatistics() const {
+  return sharedPageCache ? sharedPageCache->getStatistics()
+                         : pageCache.getStatistics();
+}
+
+void Dumper::loadExports(const std::span<const ModuleInfo *const> modules) {
+  // the workers all go through the same cache, which is only safe with the
+  // concurrent one.
+  const std::size_t workers = sharedPageCache ? workerCount : 1;
+
+  parallelFor(modules.size(), workers,
+              [&](const std::size_t i) { modules[i]->loadExports(); });
+}
+
+void Dumper::setWorkerCount(const std::size_t workerCount) {
+  this->workerCount = std::max<std::size_t>(workerCount, 1);
+}
+
+std::size_t Dumper::getWorkerCount() const { return workerCount; }
+
+void Dumper::setExportCache(std::shared_ptr<ExportCache> exportCache) {
+  this->exportCache = std::move(exportCache);
+}
+
+const std::shared_ptr<ExportCache> &Dumper::getExportCache() const {
+  return exportCache;
+}
+
+void Dumper::setReadAheadLimit(const std::uint32_t pages) {
+  readAheadLimit = pages;
+}
+
+std::uint32_t Dumper::getReadAheadLimit() const { return readAheadLimit; }
+
+void Dumper::addReadAheadPages(std::vector<std::uint64_t> &pages) {
+  if (pages.empty() || readAheadLimit == 0) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock;
+  if (sharedPageCache) {
+    lock = std::unique_lock(readAheadMutex);
+  }
+
+  const std::span<const std::uint64_t> missingPages = pages;
+  const std::size_t missingCount = pages.size();
+  std::vector<std::uint64_t> readAheadPages;
+
+  for (std::size_t i = 0; i < missingCount; i++) {
+    // only look at the first page of each run of consecutive misses.
+    if (i != 0 && pages[i] == pages[i - 1] + PageCache::PageSize) {
+      continue;
+    }
+
+    std::size_t runEnd = i + 1;
+    while (runEnd < missingCount &&
+           pages[runEnd] == pages[runEnd - 1] + PageCache::PageSize) {
+      runEnd++;
+    }
+
+    const std::uint64_t nextPage = pages[runEnd - 1] + PageCache::PageSize;
 
-  std::uint8_t header[0x1000];
-  if (!readMemoryCached(moduleInfo.getImageBase(), &header, sizeof(header),
-                        nullptr)) {
+    // a miss right where an earlier stream left off means the stream is
+    // sequential, so grow its window and read ahead of it.
+    const auto stream = std::ranges::find(readAheadStreams, pages[i],
+                                          &ReadAheadStream::NextPageVA);
+    if (stream == readAheadStreams.end()) {
+      readAheadStreams[nextReadAheadStream] = {nextPage, 0};
+      nextReadAheadStream = (nextReadAheadStream + 1) % ReadAheadStreamCount;
+      continue;
+    }
+
+    stream->Window = std::min(std::max(stream->Window * 2, 2u), readAheadLimit);
+    stream->NextPageVA = nextPage + stream->Window * PageCache::PageSize;
+
+    for (std::uint64_t page = nextPage; page < stream->NextPageVA;
+         page += PageCache::PageSize) {
+      if (!std::ranges::binary_search(missingPages, page) &&
+          (sharedPageCache ? !sharedPageCache->contains(page)
+                           : !pageCache.contains(page))) {
+        readAheadPages.push_back(page);
+      }
+    }
+  }
+
+  // the read-ahead pages are kept apart from the missing pages, so that a
+  // window running past the end of a mapping cannot fail the reads that
+  // were actually asked for.
+  std::ranges::sort(readAheadPages);
+  const auto duplicates = std::ranges::unique(readAheadPages);
+  readAheadPages.erase(duplicates.begin(), duplicates.end());
+
+  pages.insert(pages.end(), readAheadPages.begin(), readAheadPages.end());
+}
+
+bool Dumper::prefetchPages(const std::span<const std::uint64_t> pages) {
+
+  std::vector<std::uint64_t> missingPages;
+  for (const auto page : pages) {
+    if (sharedPageCache) {
+      if (sharedPageCache->claim(page).Owner) {
+        missingPages.push_back(page);
+      }
+    } else if (!pageCache.contains(page)) {
+      missingPages.push_back(page);
+    }
+  }
+
+  if (missingPages.empty()) {
+    return true;
+  }
+
+  const auto pageData = std::make_unique_for_overwrite<std::uint8_t[]>(
+      missingPages.size() * PageCache::PageSize);
+  const auto pageRead = fetchPages(missingPages, pageData.get());
+
+  for (std::size_t i = 0; i < missingPages.size(); i++) {
+    const std::uint8_t *data =
+        pageRead[i] ? pageData.get() + i * PageCache::PageSize : nullptr;
+
+    if (sharedPageCache) {
+      sharedPageCache->publish(missingPages[i], data);
+    } else if (data) {
+      if (const auto frame = pageCache.insert(missingPages[i])) {
+        std::copy_n(data, PageCache::PageSize, frame);
+      }
+    }
+  }
+
+  return std::ranges::find(pageRead, false) == pageRead.end();
+}
+
+std::vector<bool> Dumper::fetchPages(const std::span<const std::uint64_t> pages,
+                                     std::uint8_t *pageData,
+                                     const std::size_t readAheadBegin) {
+
+  // consecutive pages are coalesced into runs, each of which is read with one
+  // request, and all runs are submitted as a single batch.
+  std::vector<std::size_t> runStarts;
+  std::vector<ReadRequest> runRequests;
+  for (std::size_t i = 0; i < pages.size(); i++) {
+    if (i == 0 || i == readAheadBegin ||
+        pages[i] != pages[i - 1] + PageCache::PageSize ||
+        runRequests.back().Size == MaxCoalescedPages * PageCache::PageSize) {
+      runStarts.push_back(i);
+      runRequests.push_back(
+          {pages[i], pageData + i * PageCache::PageSize, 0, 0, false});
+    }
+    runRequests.back().Size += PageCache::PageSize;
+  }
+
+  readMemoryBatch(runRequests);
+
+  // a run fails as a whole if any of its pages is unreadable, so retry
+  // failed runs page by page to salvage whatever can still be read.
+  std::vector<bool> pageRead(pages.size(), false);
+  std::vector<std::size_t> retryPages;
+  std::vector<ReadRequest> retryRequests;
+
+  for (std::size_t i = 0; i < runRequests.size(); i++) {
+    const std::size_t runPageCount = runRequests[i].Size / PageCache::PageSize;
+
+    for (std::size_t j = runStarts[i]; j < runStarts[i] + runPageCount; j++) {
+      if (runRequests[i].Success) {
+        pageRead[j] = true;
+      } else if (runPageCount > 1 && runStarts[i] < readAheadBegin) {
+        retryPages.push_back(j);
+        retryRequests.push_back({pages[j], pageData + j * PageCache::PageSize,
+                                 PageCache::PageSize, 0, false});
+      }
+    }
+  }
+
+  if (!retryRequests.empty()) {
+    readMemoryBatch(retryRequests);
+
+    for (std::size_t i = 0; i < retryRequests.size(); i++) {
+      pageRead[retryPages[i]] = retryRequests[i].Success;
+    }
+  }
+
+  return pageRead;
+}
+
+bool Dumper::loadModuleEAT(const ModuleInfo &moduleInfo,
+                           std::vector<ModuleExportInfo> &exports) {
+
+  const std::uint64_t imageBase = moduleInfo.getImageBase();
+
+  // the headers are parsed in place, the page stays pinned until we return.
+  const auto headerView = viewMemory(imageBase, PageCache::PageSize);
+  if (headerView.getSize() != PageCache::PageSize) {
     return false;
   }
 
-  const auto optionalHeader = pe::getOptionalHeader64(header);
+  const auto headerData = headerView.getSegments().front().data();
+  const auto fileHeader = pe::getFileHeader(headerData);
+  const auto optionalHeader = pe::getOptionalHeader64(headerData);
   const auto &exportDirEntry = optionalHeader->ExportDirectory;
 
   if (exportDirEntry.VirtualAddress == 0 || exportDirEntry.Size == 0) {
     return true;
   }
 
-  pe::ImageExportDirectory exportDir = {0};
-  if (!readMemoryCached(moduleInfo.getImageBase() +
-                            exportDirEntry.VirtualAddress,
-                        &exportDir, sizeof(exportDir), nullptr)) {
+  // the PE header and the export directory header identify the build, the
+  // tables themselves are only read if the cache does not know it yet.
+  std::optional<ExportCache::Key> cacheKey;
+  if (exportCache) {
+    pe::ImageExportDirectory exportDir;
+    if (readMemoryCached(imageBase + exportDirEntry.VirtualAddress,
+                         &exportDir, sizeof(exportDir), nullptr)) {
+      cacheKey = ExportCache::Key{moduleInfo.getFilePath().string(),
+                                  fileHeader->TimeDateStamp,
+                                  optionalHeader->SizeOfImage,
+                                  optionalHeader->CheckSum,
+                                  exportDirEntry.VirtualAddress,
+                                  exportDir.NumberOfFunctions,
+                                  exportDir.NumberOfNames};
+
+      if (exportCache->find(*cacheKey, exports)) {
+        return true;
+      }
+    }
+  }
+
+  // every size below comes from target memory, so anything that does not fit
+  // inside the image is rejected before it is allocated.
+  const std::uint64_t imageSize = moduleInfo.getImageSize();
+  const auto isInsideImage = [&](const std::uint32_t rva,
+                                 const std::uint64_t size) {
+    return size <= imageSize && rva <= imageSize - size;
+  };
+
+  if (!isInsideImage(exportDirEntry.VirtualAddress, exportDirEntry.Size)) {
     return false;
   }
 
-  const std::uint64_t exportAddressTable =
-      moduleInfo.getImageBase() + exportDir.AddressOfFunctions;
-  const std::uint64_t exportNameTable =
-      moduleInfo.getImageBase() + exportDir.AddressOfNames;
-  const std::uint64_t exportNameOrdinalTable =
-      moduleInfo.getImageBase() + exportDir.AddressOfNameOrdinals;
+  // the export data directory normally holds the directory itself, all three
+  // tables and the name strings, so it is read as one region and parsed from
+  // the local copy.
+  std::vector<std::uint8_t> exportData(exportDirEntry.Size);
 
-  for (std::size_t i = 0; i < exportDir.NumberOfNames; i++) {
+  std::uint32_t exportDataSize = 0;
+  readMemoryDirect(imageBase + exportDirEntry.VirtualAddress,
+                   exportData.data(), exportDirEntry.Size, &exportDataSize);
 
-    std::uint32_t exportNameRVA;
-    if (!readMemoryCached(exportNameTable + i * sizeof(exportNameRVA),
-                          &exportNameRVA, sizeof(exportNameRVA))) {
-      return false;
+  if (exportDataSize < sizeof(pe::ImageExportDirectory)) {
+    return false;
+  }
+
+  const auto getExportData =
+      [&](const std::uint32_t rva,
+          const std::uint64_t size) -> const std::uint8_t * {
+    if (rva < exportDirEntry.VirtualAddress ||
+        rva - exportDirEntry.VirtualAddress + size > exportDataSize) {
+      return nullptr;
     }
+    return exportData.data() + (rva - exportDirEntry.VirtualAddress);
+  };
 
-    std::uint16_t exportOrdinal;
-    if (!readMemoryCached(exportNameOrdinalTable + i * sizeof(exportOrdinal),
-                          &exportOrdinal, sizeof(exportOrdinal))) {
-      return false;
+  pe::ImageExportDirectory exportDir;
+  std::memcpy(&exportDir, exportData.data(), sizeof(exportDir));
+
+  const std::uint32_t numberOfNames = exportDir.NumberOfNames;
+  const std::uint32_t numberOfFunctions = exportDir.NumberOfFunctions;
+
+  if (!isInsideImage(exportDir.AddressOfNames,
+                     std::uint64_t{numberOfNames} * sizeof(std::uint32_t)) ||
+      !isInsideImage(exportDir.AddressOfNameOrdinals,
+                     std::uint64_t{numberOfNames} * sizeof(std::uint16_t)) ||
+      !isInsideImage(exportDir.AddressOfFunctions,
+                     std::uint64_t{numberOfFunctions} *
+                         sizeof(std::uint32_t))) {
+    return false;
+  }
+
+  std::vector<std::uint32_t> exportNameRVAs(numberOfNames);
+  std::vector<std::uint16_t> exportOrdinals(numberOfNames);
+  std::vector<std::uint32_t> exportFunctionRVAs(numberOfFunctions);
+
+  // tables that live outside of the export data directory are read with one
+  // batch.
+  std::vector<ReadRequest> requests;
+
+  const auto loadTable = [&](const std::uint32_t rva, void *table,
+                             const std::uint64_t size) {
+    if (size == 0) {
+      return;
     }
 
-    std::uint32_t exportFunctionRVA;
-    if (!readMemoryCached(exportAddressTable +
-                              exportOrdinal * sizeof(exportFunctionRVA),
-                          &exportFunctionRVA, sizeof(exportFunctionRVA))) {
-      return false;
+    if (const auto data = getExportData(rva, size)) {
+      std::memcpy(table, data, size);
+    } else {
+      requests.push_back({imageBase + rva, table,
+                          static_cast<std::uint32_t>(size), 0, false});
+    }
+  };
+
+  loadTable(exportDir.AddressOfNames, exportNameRVAs.data(),
+            exportNameRVAs.size() * sizeof(std::uint32_t));
+  loadTable(exportDir.AddressOfNameOrdinals, exportOrdinals.data(),
+            exportOrdinals.size() * sizeof(std::uint16_t));
+  loadTable(exportDir.AddressOfFunctions, exportFunctionRVAs.data(),
+            exportFunctionRVAs.size() * sizeof(std::uint32_t));
+
+  if (!requests.empty() && !readMemoryCachedBatch(requests)) {
+    return false;
+  }
+
+  // names are cut out of the local copy, the few that are not fully inside
+  // of it are read separately.
+  constexpr std::uint32_t maxNameLength = 250;
+
+  std::vector<std::string> exportNames(numberOfNames);
+  std::vector<std::size_t> outsideNames;
+  std::vector<std::uint64_t> outsideNameVAs;
+
+  for (std::size_t i = 0; i < numberOfNames; i++) {
+    const std::uint32_t nameRVA = exportNameRVAs[i];
+
+    const std::uint8_t *name = nullptr;
+    std::uint32_t available = 0;
+
+    if (nameRVA >= exportDirEntry.VirtualAddress &&
+        nameRVA - exportDirEntry.VirtualAddress < exportDataSize) {
+      name = exportData.data() + (nameRVA - exportDirEntry.VirtualAddress);
+      available = std::min(maxNameLength,
+                           exportDataSize -
+                               (nameRVA - exportDirEntry.VirtualAddress));
     }
 
-    std::string exportName;
-    if (!readString(moduleInfo.getImageBase() + exportNameRVA, exportName,
-                    250)) {
+    const auto terminator = name ? std::memchr(name, '\0', available) : nullptr;
+
+    if (terminator) {
+      exportNames[i].assign(reinterpret_cast<const char *>(name),
+                            static_cast<const std::uint8_t *>(terminator) -
+                                name);
+    } else if (available == maxNameLength) {
+      exportNames[i].assign(reinterpret_cast<const char *>(name),
+                            maxNameLength);
+    } else {
+      outsideNames.push_back(i);
+      outsideNameVAs.push_back(imageBase + nameRVA);
+    }
+  }
+
+  if (!outsideNames.empty()) {
+    std::vector<std::string> names;
+    if (!readStrings(outsideNameVAs, names, maxNameLength)) {
       return false;
     }
 
-    ModuleExportInfo exportInfo(exportName, exportOrdinal, exportFunctionRVA);
-    moduleInfo.addExport(exportInfo);
+    for (std::size_t i = 0; i < outsideNames.size(); i++) {
+      exportNames[outsideNames[i]] = std::move(names[i]);
+    }
+  }
+
+  for (std::size_t i = 0; i < numberOfNames; i++) {
+    const std::uint16_t exportOrdinal = exportOrdinals[i];
+    if (exportOrdinal >= numberOfFunctions) {
+      continue;
+    }
+
+    exports.emplace_back(std::move(exportNames[i]), exportOrdinal,
+                         exportFunctionRVAs[exportOrdinal]);
+  }
+
+  if (cacheKey) {
+    exportCache->store(*cacheKey, exports);
   }
 
   return true;
@@ -2,6 +2,8 @@
 #include <dmadump/PE.hpp>
 #include <dmadump/Utils.hpp>
 #include <dmadump/Logging.hpp>
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <format>
 
@@ -41,11 +43,7 @@ bool VmmDumper::loadModuleInfo() {
     ModuleInfo moduleInfo(
         std::filesystem::path(moduleEntry.uszText).filename().string(),
         moduleEntry.uszFullName, moduleEntry.vaBase, moduleEntry.cbImageSize,
-        {});
-
-    if (!loadModuleEAT(moduleInfo)) {
-      LOG_WARN("failed to load EAT for module: {}", moduleInfo.getName());
-    }
+        {}, this);
 
     moduleList->addModule(std::move(moduleInfo));
   }
@@ -64,6 +62,43 @@ bool VmmDumper::readMemory(const std::uint64_t va, void *buffer,
                           reinterpret_cast<PDWORD>(bytesRead), 0);
 }
 
+bool VmmDumper::readMemoryBatch(const std::span<ReadRequest> requests) {
+
+  const VMMDLL_SCATTER_HANDLE scatterHandle =
+      VMMDLL_Scatter_Initialize(getRawHandle(), processID, 0);
+  if (!scatterHandle) {
+    return Dumper::readMemoryBatch(requests);
+  }
+
+  for (auto &request : requests) {
+    // match VMMDLL_MemReadEx, which zero-fills whatever could not be read.
+    std::memset(request.Buffer, 0, request.Size);
+
+    request.BytesRead = 0;
+    request.Success = VMMDLL_Scatter_PrepareEx(
+        scatterHandle, request.VA, request.Size,
+        static_cast<PBYTE>(request.Buffer),
+        reinterpret_cast<PDWORD>(&request.BytesRead));
+  }
+
+  const bool executed = VMMDLL_Scatter_Execute(scatterHandle);
+
+  VMMDLL_Scatter_CloseHandle(scatterHandle);
+
+  if (!executed) {
+    return Dumper::readMemoryBatch(requests);
+  }
+
+  // PrepareEx only reports that the read was queued, the pages that could
+  // not be read come back zero-filled and short.
+  for (auto &request : requests) {
+    request.Success = request.BytesRead == request.Size;
+  }
+
+  return std::ranges::all_of(
+      requests, [](const ReadRequest &request) { return request.Success; });
+}
+
 VMM_HANDLE VmmDumper::getRawHandle() const {
   switch (vmmHandle.index()) {
   case 0:
@@ -59,11 +59,7 @@ bool Win32Dumper::loadModuleInfo() {
           std::filesystem::path(moduleEntry.szModule).string(),
           moduleEntry.szExePath,
           reinterpret_cast<std::uint64_t>(moduleEntry.modBaseAddr),
-          moduleEntry.modBaseSize, {});
-
-      if (!loadModuleEAT(moduleInfo)) {
-        LOG_WARN("failed to load EAT for module: {}", moduleInfo.getName());
-      }
+          moduleEntry.modBaseSize, {}, this);
 
       moduleList->addModule(std::move(moduleInfo));
     } while (Module32NextW(snapshotHandle, &moduleEntry));
@@ -0,0 +1,84 @@
+#include <dmadump/ExportAddressIndex.hpp>
+#include <dmadump/ModuleInfo.hpp>
+#include <algorithm>
+#include <numeric>
+
+namespace dmadump {
+ExportAddressIndex::ExportAddressIndex(
+    const std::span<const ModuleInfo *const> modules) {
+
+  std::vector<std::uint64_t> unsortedAddresses;
+  std::vector<Entry> unsortedEntries;
+
+  for (const auto moduleInfo : modules) {
+    for (const auto &exportInfo : moduleInfo->getExports()) {
+      unsortedAddresses.push_back(moduleInfo->getImageBase() +
+                                  exportInfo.getRVA());
+      unsortedEntries.push_back({moduleInfo, &exportInfo});
+    }
+  }
+
+  // a stable sort keeps the first export of every address in front, which is
+  // the one ModuleInfo::getExportByVA returns.
+  std::vector<std::uint32_t> order(unsortedAddresses.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(order, {}, [&](const std::uint32_t i) {
+    return unsortedAddresses[i];
+  });
+
+  for (const auto i : order) {
+    if (addresses.empty() || addresses.back() != unsortedAddresses[i]) {
+      addresses.push_back(unsortedAddresses[i]);
+      entries.push_back(unsortedEntries[i]);
+    }
+  }
+}
+
+const ExportAddressIndex::Entry *
+ExportAddressIndex::find(const std::uint64_t va) const {
+  std::uint32_t result;
+  findBatch({&va, 1}, {&result, 1});
+  return result != NotFound ? &entries[result] : nullptr;
+}
+
+void ExportAddressIndex::findBatch(const std::span<const std::uint64_t> vas,
+                                   const std::span<std::uint32_t> results) const {
+
+  if (addresses.empty()) {
+    std::ranges::fill(results, NotFound);
+    return;
+  }
+
+  // the search length only depends on the size of the array, so every lane
+  // of a block steps in lockstep and the loads of all lanes overlap.
+  for (std::size_t block = 0; block < vas.size(); block += BatchLanes) {
+    const std::size_t lanes = std::min(BatchLanes, vas.size() - block);
+
+    std::size_t first[BatchLanes] = {};
+    for (std::size_t count = addresses.size(); count > 1;) {
+      const std::size_t half = count / 2;
+
+      for (std::size_t lane = 0; lane < lanes; lane++) {
+        first[lane] = addresses[first[lane] + half] <= vas[block + lane]
+                          ? first[lane] + half
+                          : first[lane];
+      }
+
+      count -= half;
+    }
+
+    for (std::size_t lane = 0; lane < lanes; lane++) {
+      results[block + lane] = addresses[first[lane]] == vas[block + lane]
+                                  ? static_cast<std::uint32_t>(first[lane])
+                                  : NotFound;
+    }
+  }
+}
+
+const ExportAddressIndex::Entry &
+ExportAddressIndex::getEntry(const std::uint32_t index) const {
+  return entries[index];
+}
+
+std::size_t ExportAddressIndex::getSize() const { return addresses.size(); }
+} // namespace dmadump
@@ -0,0 +1,249 @@
+#include <dmadump/ExportCache.hpp>
+#include <fstream>
+#include <functional>
+
+namespace dmadump {
+bool ExportCache::load(const std::filesystem::path &filePath) {
+  std::lock_guard lock(mutex);
+
+  fileData.clear();
+  fileEntries.clear();
+  storedEntries.clear();
+  dirty = false;
+
+  std::ifstream file(filePath, std::ios::in | std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  file.seekg(0, std::ios::end);
+  const auto fileSize = static_cast<std::size_t>(file.tellg());
+  file.seekg(0, std::ios::beg);
+
+  fileData.resize(fileSize);
+  if (!file.read(reinterpret_cast<char *>(fileData.data()),
+                 static_cast<std::streamsize>(fileSize)) ||
+      !validate()) {
+    fileData.clear();
+    return false;
+  }
+
+  const auto entries = getEntries();
+  for (std::uint32_t i = 0; i < getHeader()->EntryCount; i++) {
+    fileEntries.emplace(getKey(entries[i]), i);
+  }
+
+  return true;
+}
+
+bool ExportCache::save(const std::filesystem::path &filePath) const {
+  std::lock_guard lock(mutex);
+
+  std::vector<FileEntry> entries;
+  std::vector<FileExport> exports;
+  std::string stringPool;
+
+  const auto addString = [&](const std::string_view str) {
+    const auto offset = static_cast<std::uint32_t>(stringPool.size());
+    stringPool.append(str);
+    return offset;
+  };
+
+  const auto addEntry = [&](const Key &key, const auto &entryExports) {
+    FileEntry entry;
+    entry.PathOffset = addString(key.Path);
+    entry.PathSize = static_cast<std::uint32_t>(key.Path.size());
+    entry.TimeDateStamp = key.TimeDateStamp;
+    entry.SizeOfImage = key.SizeOfImage;
+    entry.CheckSum = key.CheckSum;
+    entry.ExportDirectoryRVA = key.ExportDirectoryRVA;
+    entry.NumberOfFunctions = key.NumberOfFunctions;
+    entry.NumberOfNames = key.NumberOfNames;
+    entry.FirstExport = static_cast<std::uint32_t>(exports.size());
+    entry.ExportCount = static_cast<std::uint32_t>(entryExports.size());
+    entries.push_back(entry);
+
+    for (const auto &exportInfo : entryExports) {
+      const std::string_view name = exportInfo.getName();
+      exports.push_back({exportInfo.getRVA(), addString(name),
+                         static_cast<std::uint16_t>(name.size()),
+                         exportInfo.getOrdinal()});
+    }
+  };
+
+  // entries that came from the file are kept unless they were replaced.
+  for (const auto &[key, index] : fileEntries) {
+    if (storedEntries.contains(key)) {
+      continue;
+    }
+
+    std::vector<ModuleExportInfo> entryExports;
+    const auto &entry = getEntries()[index];
+    const auto fileExports = getExports() + entry.FirstExport;
+    for (std::uint32_t i = 0; i < entry.ExportCount; i++) {
+      entryExports.emplace_back(
+          std::string_view(getStringPool() + fileExports[i].NameOffset,
+                           fileExports[i].NameSize),
+          fileExports[i].Ordinal, fileExports[i].RVA);
+    }
+
+    addEntry(key, entryExports);
+  }
+
+  for (const auto &[key, entryExports] : storedEntries) {
+    addEntry(key, entryExports);
+  }
+
+  FileHeader header;
+  header.Magic = Magic;
+  header.Version = Version;
+  header.EntryCount = static_cast<std::uint32_t>(entries.size());
+  header.ExportCount = static_cast<std::uint32_t>(exports.size());
+  header.StringPoolSize = static_cast<std::uint32_t>(stringPool.size());
+
+  std::ofstream file(filePath,
+                     std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(entries.data()),
+             static_cast<std::streamsize>(entries.size() * sizeof(FileEntry)));
+  file.write(reinterpret_cast<const char *>(exports.data()),
+             static_cast<std::streamsize>(exports.size() * sizeof(FileExport)));
+  file.write(stringPool.data(),
+             static_cast<std::streamsize>(stringPool.size()));
+
+  return static_cast<bool>(file);
+}
+
+bool ExportCache::find(const Key &key,
+                       std::vector<ModuleExportInfo> &exports) const {
+  std::lock_guard lock(mutex);
+
+  if (const auto found = storedEntries.find(key);
+      found != storedEntries.end()) {
+    exports = found->second;
+    return true;
+  }
+
+  const auto found = fileEntries.find(key);
+  if (found == fileEntries.end()) {
+    return false;
+  }
+
+  const auto &entry = getEntries()[found->second];
+  const auto fileExports = getExports() + entry.FirstExport;
+
+  exports.clear();
+  exports.reserve(entry.ExportCount);
+
+  for (std::uint32_t i = 0; i < entry.ExportCount; i++) {
+    exports.emplace_back(std::string_view(getStringPool() +
+                                              fileExports[i].NameOffset,
+                                          fileExports[i].NameSize),
+                         fileExports[i].Ordinal, fileExports[i].RVA);
+  }
+
+  return true;
+}
+
+void ExportCache::store(const Key &key,
+                        const std::vector<ModuleExportInfo> &exports) {
+  std::lock_guard lock(mutex);
+
+  storedEntries.insert_or_assign(key, exports);
+  dirty = true;
+}
+
+bool ExportCache::isDirty() const {
+  std::lock_guard lock(mutex);
+  return dirty;
+}
+
+std::size_t ExportCache::KeyHash::operator()(const Key &key) const {
+  std::size_t hash = std::hash<std::string>{}(key.Path);
+  for (const std::uint32_t value :
+       {key.TimeDateStamp, key.SizeOfImage, key.CheckSum,
+        key.ExportDirectoryRVA, key.NumberOfFunctions, key.NumberOfNames}) {
+    hash = hash * 31 + value;
+  }
+  return hash;
+}
+
+const ExportCache::FileHeader *ExportCache::getHeader() const {
+  return reinterpret_cast<const FileHeader *>(fileData.data());
+}
+
+const ExportCache::FileEntry *ExportCache::getEntries() const {
+  return reinterpret_cast<const FileEntry *>(fileData.data() +
+                                             sizeof(FileHeader));
+}
+
+const ExportCache::FileExport *ExportCache::getExports() const {
+  return reinterpret_cast<const FileExport *>(getEntries() +
+                                              getHeader()->EntryCount);
+}
+
+const char *ExportCache::getStringPool() const {
+  return reinterpret_cast<const char *>(getExports() +
+                                        getHeader()->ExportCount);
+}
+
+bool ExportCache::validate() const {
+  if (fileData.size() < sizeof(FileHeader)) {
+    return false;
+  }
+
+  const auto header = getHeader();
+  if (header->Magic != Magic || header->Version != Version) {
+    return false;
+  }
+
+  const std::uint64_t expectedSize =
+      sizeof(FileHeader) +
+      static_cast<std::uint64_t>(header->EntryCount) * sizeof(FileEntry) +
+      static_cast<std::uint64_t>(header->ExportCount) * sizeof(FileExport) +
+      header->StringPoolSize;
+
+  if (fileData.size() != expectedSize) {
+    return false;
+  }
+
+  // everything is addressed by offsets, make sure none of them point outside
+  // of the file so that lookups do not need to check.
+  const auto entries = getEntries();
+  for (std::uint32_t i = 0; i < header->EntryCount; i++) {
+    if (static_cast<std::uint64_t>(entries[i].PathOffset) +
+                entries[i].PathSize >
+            header->StringPoolSize ||
+        static_cast<std::uint64_t>(entries[i].FirstExport) +
+                entries[i].ExportCount >
+            header->ExportCount) {
+      return false;
+    }
+  }
+
+  const auto exports = getExports();
+  for (std::uint32_t i = 0; i < header->ExportCount; i++) {
+    if (static_cast<std::uint64_t>(exports[i].NameOffset) +
+            exports[i].NameSize >
+        header->StringPoolSize) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+ExportCache::Key ExportCache::getKey(const FileEntry &entry) const {
+  return {std::string(getStringPool() + entry.PathOffset, entry.PathSize),
+          entry.TimeDateStamp,
+          entry.SizeOfImage,
+          entry.CheckSum,
+          entry.ExportDirectoryRVA,
+          entry.NumberOfFunctions,
+          entry.NumberOfNames};
+}
+} // namespace dmadump
@@ -1,9 +1,15 @@
 #include <dmadump/IAT/DynamicIATResolver.hpp>
 #include <dmadump/Dumper.hpp>
+#include <dmadump/ExportAddressIndex.hpp>
 #include <dmadump/ModuleList.hpp>
 #include <dmadump/IATBuilder.hpp>
 #include <dmadump/Logging.hpp>
+#include <dmadump/PointerFilter.hpp>
+#include <dmadump/RipReferenceIndex.hpp>
 #include <dmadump/Utils.hpp>
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
 
 namespace dmadump {
 DynamicIATResolver::DynamicIATResolver(IATBuilder &iatBuilder,
@@ -13,66 +19,130 @@ DynamicIATResolver::DynamicIATResolver(IATBuilder &iatBuilder,
       allowedScnAttrs(allowedScnAttrs) {}
 
 bool DynamicIATResolver::resolve(const std::vector<std::uint8_t> &image) {
-  const auto ntHeaders = pe::getNtHeaders(image.data());
-  const auto &importDir = ntHeaders->OptionalHeader64.ImportDirectory;
+  const auto &imageView = getImageView(image);
+  const auto &importDir = imageView.getOptionalHeader()->ImportDirectory;
 
   const auto &moduleList = *iatBuilder.getDumper().getModuleList();
-  const auto lowModStartAddr = getLowestModuleStartAddress();
-  const auto highModEndAddr = getHighestModuleEndAddress();
-
-  for (std::uint16_t i = 0; i < ntHeaders->getSectionCount(); ++i) {
-    const auto section = ntHeaders->getSectionHeader(i);
+  const PointerFilter pointerFilter(getLowestModuleStartAddress(),
+                                    getHighestModuleEndAddress());
+
+  // collect every pointer that lands inside of a module first, so that the
+  // exports of the modules involved can be loaded together.
+  std::vector<std::uint32_t> candidateRVAs;
+  std::vector<std::uint64_t> candidateVAs;
+  std::vector<const ModuleInfo *> candidateModules;
+  std::unordered_set<const ModuleInfo *> seenModules;
+
+  const auto addCandidate = [&](const std::uint32_t rva,
+                                const std::uint64_t candidate) {
+    if (importDir.contains(rva)) {
+      return;
+    }
 
-    if ((section->VirtualAddress & 0xfff) != 0 ||
-        section->Misc.VirtualSize < 8) {
-      continue;
+    const auto moduleInfo = moduleList.getModuleByAddress(candidate);
+    if (!moduleInfo) {
+      return;
     }
 
-    if ((section->Characteristics & requiredScnAttrs) != requiredScnAttrs ||
-        (section->Characteristics & ~allowedScnAttrs) != 0) {
-      continue;
+    if (seenModules.insert(moduleInfo).second) {
+      candidateModules.push_back(moduleInfo);
     }
 
-    const auto sectionBegin = reinterpret_cast<const std::uint64_t *>(
-        image.data() + section->VirtualAddress);
+    candidateRVAs.push_back(rva);
+    candidateVAs.push_back(candidate);
+  };
 
-    const auto sectionEnd = reinterpret_cast<const std::uint64_t *>(
-        image.data() + section->VirtualAddress + section->Misc.VirtualSize -
-        section->Misc.VirtualSize % 8);
+  std::vector<std::uint32_t> slotRVAs;
+  if (scanMode == ScanMode::Relocations &&
+      !findRelocatedSlots(imageView, slotRVAs)) {
+    LOG_WARN("no base relocations found, scanning sections instead.");
+  }
+
+  if (!slotRVAs.empty()) {
+    // the bounds are computed in 64 bits, so that neither a malformed
+    // section header nor a malformed relocation can wrap them.
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> scannedRanges;
+    for (const auto &section : imageView.getSections()) {
+      if (isScannedSection(section)) {
+        scannedRanges.emplace_back(
+            section.VirtualAddress,
+            std::uint64_t{section.VirtualAddress} + section.Misc.VirtualSize);
+      }
+    }
 
-    for (auto it = sectionBegin; it != sectionEnd; ++it) {
-      const auto rva = static_cast<std::uint32_t>(
-          reinterpret_cast<const std::uint8_t *>(it) - image.data());
+    // relocated slots hold absolute pointers and need not be aligned.
+    for (const auto rva : slotRVAs) {
+      const std::uint64_t slotEnd = std::uint64_t{rva} + sizeof(std::uint64_t);
 
-      if (importDir.contains(rva)) {
+      if (slotEnd > image.size() ||
+          std::ranges::none_of(scannedRanges, [&](const auto &range) {
+            return rva >= range.first && slotEnd <= range.second;
+          })) {
         continue;
       }
 
-      const std::uint64_t candidate = *it;
-      if (candidate < lowModStartAddr || candidate >= highModEndAddr) {
-        continue;
+      std::uint64_t candidate;
+      std::memcpy(&candidate, image.data() + rva, sizeof(candidate));
+
+      if (pointerFilter.contains(candidate)) {
+        addCandidate(rva, candidate);
       }
+    }
+  } else {
+    std::vector<std::uint32_t> sectionCandidates;
 
-      const auto moduleInfo = moduleList.getModuleByAddress(candidate);
-      if (!moduleInfo) {
+    for (const auto &section : imageView.getSections()) {
+
+      if ((section.VirtualAddress & 0xfff) != 0 ||
+          section.Misc.VirtualSize < 8 || !isScannedSection(section)) {
         continue;
       }
 
-      const auto exportInfo = moduleInfo->getExportByVA(candidate);
-      if (!exportInfo) {
-        continue;
+      const std::span sectionQwords(
+          reinterpret_cast<const std::uint64_t *>(image.data() +
+                                                  section.VirtualAddress),
+          section.Misc.VirtualSize / 8);
+
+      // most qwords are rejected by the range check alone, only the rest is
+      // classified one by one.
+      sectionCandidates.clear();
+      pointerFilter.filter(sectionQwords, sectionCandidates);
+
+      for (const auto index : sectionCandidates) {
+        addCandidate(section.VirtualAddress + index * 8,
+                     sectionQwords[index]);
       }
+    }
+  }
+
+  // only modules that actually contain a candidate ever have their EAT read.
+  iatBuilder.getDumper().loadExports(candidateModules);
 
-      ResolvedImport resolvedImport;
-      resolvedImport.Library = moduleInfo->getName();
-      resolvedImport.Function = exportInfo->getName();
+  // classify all candidates against the exports of those modules at once.
+  const ExportAddressIndex exportIndex(candidateModules);
 
-      resolvedImports.push_back(resolvedImport);
-      resolvedImportsByRVAs.insert({rva, resolvedImport});
+  std::vector<std::uint32_t> candidateExports(candidateVAs.size());
+  exportIndex.findBatch(candidateVAs, candidateExports);
 
-      LOG_INFO("found import {}:{} at RVA 0x{:X}", moduleInfo->getName(),
-               exportInfo->getName(), rva);
+  for (std::size_t i = 0; i < candidateRVAs.size(); i++) {
+    if (candidateExports[i] == ExportAddressIndex::NotFound) {
+      continue;
     }
+
+    const std::uint32_t rva = candidateRVAs[i];
+    const auto &[moduleInfo, exportInfo] =
+        exportIndex.getEntry(candidateExports[i]);
+
+    ResolvedImport resolvedImport;
+    resolvedImport.ModuleIndex = moduleInfo->getIndex();
+    resolvedImport.ExportIndex = static_cast<std::uint32_t>(
+        exportInfo - moduleInfo->getExports().data());
+
+    resolvedImports.push_back(resolvedImport);
+    resolvedImportsByRVAs.insert({rva, resolvedImport});
+
+    LOG_INFO("found import {}:{} at RVA 0x{:X}", moduleInfo->getName(),
+             exportInfo->getName(), rva);
   }
 
   LOG_INFO("resolved {} dynamic imports.", resolvedImportsByRVAs.size());
@@ -87,15 +157,14 @@ const std::vector<ResolvedImport> &DynamicIATResolver::getImports() const {
 bool DynamicIATResolver::applyPatches(std::vector<std::uint8_t> &image,
                                       SectionBuilder &codeScn) {
 
-  const auto ntHeaders = pe::getNtHeaders(image.data());
-  const auto &importDir = ntHeaders->OptionalHeader64.ImportDirectory;
+  const auto &imageView = getImageView(image);
 
   LOG_INFO("redirecting dynamic IAT to stubs...");
 
   std::size_t iatPatchCount = 0;
   for (const auto &[functionPtrRVA, resolvedImport] : resolvedImportsByRVAs) {
-    if (const auto importFunction = iatBuilder.findImportFunction(
-            resolvedImport.Library, resolvedImport.Function)) {
+    if (const auto importFunction =
+            iatBuilder.findImportFunction(resolvedImport)) {
 
       *reinterpret_cast<std::uint64_t *>(image.data() + functionPtrRVA) =
           iatBuilder.getModuleInfo()->getImageBase() +
@@ -107,88 +176,124 @@ bool DynamicIATResolver::applyPatches(std::vector<std::uint8_t> &image,
 
   LOG_INFO("patched {} dynamic IAT entries.", iatPatchCount);
 
-  LOG_INFO("searching for dynamic IAT calls...");
+  LOG_INFO("searching for dynamic IAT references...");
 
-  std::unordered_map<std::uint32_t, ResolvedImport> callSites;
-  for (std::uint16_t i = 0; i < ntHeaders->getSectionCount(); ++i) {
-    const auto section = ntHeaders->getSectionHeader(i);
+  // one pass over the code finds the calls, jumps and loads through every
+  // pointer at once.
+  RipReferenceIndex referenceIndex;
+  for (const auto &section : imageView.getSections()) {
 
-    if (!(section->Characteristics & IMAGE_SCN_MEM_EXECUTE)) {
+    if (!(section.Characteristics & IMAGE_SCN_MEM_EXECUTE) ||
+        section.VirtualAddress >= image.size()) {
       continue;
     }
 
-    const auto sectionBegin = reinterpret_cast<std::uint8_t *>(image.data()) +
-                              section->VirtualAddress;
-    const auto sectionEnd = sectionBegin + section->Misc.VirtualSize;
+    referenceIndex.addCode(
+        {image.data() + section.VirtualAddress,
+         std::min<std::size_t>(section.Misc.VirtualSize,
+                               image.size() - section.VirtualAddress)},
+        section.VirtualAddress);
+  }
 
-    for (const auto &[functionPtrRVA, resolvedImport] : resolvedImportsByRVAs) {
+  std::vector<std::pair<RipReference, ResolvedImport>> references;
+  for (const auto &[functionPtrRVA, resolvedImport] : resolvedImportsByRVAs) {
+    for (const auto &reference : referenceIndex.find(functionPtrRVA)) {
+      references.emplace_back(reference, resolvedImport);
+    }
+  }
 
-      for (const auto &callRVA :
-           findDirectCalls(sectionBegin, sectionEnd, section->VirtualAddress,
-                           functionPtrRVA)) {
+  LOG_INFO("found {} dynamic IAT references.", references.size());
 
-        // LOG_INFO("found dynamic call at RVA 0x{:X}", callRVA);
+  LOG_INFO("patching dynamic IAT references...");
 
-        callSites[callRVA] = resolvedImport;
-      }
+  std::size_t referencePatchCount = 0;
+  for (const auto &[reference, resolvedImport] : references) {
+
+    const auto firstThunkRVA = iatBuilder.getImportThunk(resolvedImport);
+    if (!firstThunkRVA) {
+      continue;
     }
+
+    // every kind reads or addresses the new thunk the same way it did the
+    // old slot.
+    const auto displacement = static_cast<std::int32_t>(
+        *firstThunkRVA - (reference.SiteRVA + reference.Length));
+
+    std::memcpy(image.data() + reference.SiteRVA +
+                    reference.DisplacementOffset,
+                &displacement, sizeof(displacement));
+
+    ++referencePatchCount;
   }
 
-  LOG_INFO("found {} dynamic IAT calls.", callSites.size());
+  LOG_INFO("patched {} dynamic IAT references.", referencePatchCount);
 
-  LOG_INFO("patching dynamic IAT calls...");
+  return true;
+}
 
-  std::size_t callPatchCount = 0;
-  for (const auto &[callSite, resolvedImport] : callSites) {
+const std::unordered_map<std::uint32_t, ResolvedImport> &
+DynamicIATResolver::getResolvedImportsByRVAs() const {
+  return resolvedImportsByRVAs;
+}
 
-    auto importDesc = reinterpret_cast<const pe::ImageImportDescriptor *>(
-        image.data() + importDir.VirtualAddress);
+DynamicIATResolver::ScanMode DynamicIATResolver::getScanMode() const {
+  return scanMode;
+}
 
-    for (; importDesc->Name != 0; ++importDesc) {
+void DynamicIATResolver::setScanMode(const ScanMode mode) { scanMode = mode; }
 
-      const auto libraryName =
-          reinterpret_cast<const char *>(image.data() + importDesc->Name);
+bool DynamicIATResolver::isScannedSection(
+    const pe::ImageSectionHeader &section) const {
+  return (section.Characteristics & requiredScnAttrs) == requiredScnAttrs &&
+         (section.Characteristics & ~allowedScnAttrs) == 0;
+}
 
-      if (!compareLibraryName(libraryName, resolvedImport.Library)) {
-        continue;
-      }
+bool DynamicIATResolver::findRelocatedSlots(
+    const pe::ImageView &imageView, std::vector<std::uint32_t> &slotRVAs) {
+
+  const auto image = imageView.getData();
+  const auto &relocDir = imageView.getOptionalHeader()->BaseRelocDirectory;
 
-      auto originalFirstThunk = reinterpret_cast<const pe::ImageThunkData64 *>(
-          image.data() + importDesc->OriginalFirstThunk);
-      auto firstThunk = reinterpret_cast<const pe::ImageThunkData64 *>(
-          image.data() + importDesc->FirstThunk);
+  if (!relocDir.VirtualAddress || !relocDir.Size ||
+      static_cast<std::uint64_t>(relocDir.VirtualAddress) + relocDir.Size >
+          image.size()) {
+    return false;
+  }
 
-      for (; originalFirstThunk->u1.AddressOfData != 0;
-           ++originalFirstThunk, ++firstThunk) {
+  const std::uint8_t *block = image.data() + relocDir.VirtualAddress;
+  const std::uint8_t *const end = block + relocDir.Size;
 
-        const auto importByName =
-            reinterpret_cast<const pe::ImageImportByName *>(
-                image.data() + originalFirstThunk->u1.AddressOfData);
+  while (block + sizeof(pe::ImageBaseRelocation) <= end) {
+    pe::ImageBaseRelocation header;
+    std::memcpy(&header, block, sizeof(header));
 
-        if (importByName->Name != resolvedImport.Function) {
-          continue;
-        }
+    // the directory of a driver may have been discarded after loading and
+    // read back as zeros.
+    if (header.SizeOfBlock < sizeof(header) ||
+        header.SizeOfBlock > static_cast<std::size_t>(end - block)) {
+      break;
+    }
 
-        const auto addressOfDataRVA =
-            *ntHeaders->fileOffsetToRVA(reinterpret_cast<const std::uint8_t *>(
-                                            &firstThunk->u1.AddressOfData) -
-                                        image.data());
+    const std::size_t entryCount =
+        (header.SizeOfBlock - sizeof(header)) / sizeof(std::uint16_t);
 
-        *reinterpret_cast<std::int32_t *>(image.data() + callSite + 2) =
-            static_cast<std::int32_t>(addressOfDataRVA - (callSite + 6));
+    for (std::size_t i = 0; i < entryCount; i++) {
+      std::uint16_t entry;
+      std::memcpy(&entry, block + sizeof(header) + i * sizeof(entry),
+                  sizeof(entry));
 
-        ++callPatchCount;
+      const std::uint32_t rva = header.VirtualAddress + (entry & 0xfff);
+
+      if ((entry >> 12) == IMAGE_REL_BASED_DIR64 &&
+          static_cast<std::uint64_t>(rva) + sizeof(std::uint64_t) <=
+              image.size()) {
+        slotRVAs.push_back(rva);
       }
     }
-  }
-
-  LOG_INFO("patched {} dynamic IAT calls", callPatchCount);
 
-  return true;
-}
+    block += header.SizeOfBlock;
+  }
 
-const std::unordered_map<std::uint32_t, ResolvedImport> &
-DynamicIATResolver::getResolvedImportsByRVAs() const {
-  return resolvedImportsByRVAs;
+  return !slotRVAs.empty();
 }
 } // namespace dmadump
@@ -13,48 +13,137 @@ namespace dmadump {
 IATBuilder::IATBuilder(Dumper &dumper, const ModuleInfo *moduleInfo)
     : dumper(dumper), moduleInfo(moduleInfo) {}
 
-void IATBuilder::addImport(const std::string &libraryName,
+void IATBuilder::addImport(const std::string_view libraryName,
                            const ImportFunction &function) {
+  addImportSlot(libraryName, function);
+}
 
-  for (auto &imp : imports) {
-    if (compareLibraryName(imp.getName(), libraryName)) {
-      imp.addFunction(function);
-      return;
-    }
+bool IATBuilder::addImport(const ResolvedImport &import) {
+
+  if (importsByHandle.contains(import)) {
+    return true;
+  }
+
+  const auto importModule =
+      dumper.getModuleList()->getModuleByIndex(import.ModuleIndex);
+  if (!importModule ||
+      import.ExportIndex >= importModule->getExports().size()) {
+    return false;
+  }
+
+  const auto &exportInfo = importModule->getExports()[import.ExportIndex];
+
+  // the ordinal stored with an export is its index into the ordinal table,
+  // not the biased ordinal an import would need, so only named exports can
+  // be imported.
+  if (exportInfo.getName().empty()) {
+    return false;
+  }
+
+  importsByHandle.emplace(
+      import, addImportSlot(importModule->getName(),
+                            ImportFunction::fromName(exportInfo.getName())));
+  return true;
+}
+
+IATBuilder::ImportSlot
+IATBuilder::addImportSlot(const std::string_view libraryName,
+                          const ImportFunction &function) {
+
+  const auto [found, inserted] = importsByLibrary.try_emplace(
+      getLibraryKey(libraryName), static_cast<std::uint32_t>(imports.size()));
+
+  if (inserted) {
+    imports.emplace_back(InternedString(libraryName),
+                         std::vector<ImportFunction>{});
+  }
+
+  return {found->second, imports[found->second].addFunction(function)};
+}
+
+std::string IATBuilder::getLibraryKey(const std::string_view libraryName) {
+  return toLower(libraryName.substr(0, libraryName.find_last_of('.')));
+}
+
+IATBuilder::ImportLibrary *
+IATBuilder::findImportLibrary(const std::string_view libraryName) {
+  if (const auto found = importsByLibrary.find(getLibraryKey(libraryName));
+      found != importsByLibrary.end()) {
+    return &imports[found->second];
   }
+  return nullptr;
+}
 
-  imports.emplace_back(libraryName, std::vector{function});
+const IATBuilder::ImportLibrary *
+IATBuilder::findImportLibrary(const std::string_view libraryName) const {
+  if (const auto found = importsByLibrary.find(getLibraryKey(libraryName));
+      found != importsByLibrary.end()) {
+    return &imports[found->second];
+  }
+  return nullptr;
 }
 
 Dumper &IATBuilder::getDumper() const { return dumper; }
 
 const ModuleInfo *IATBuilder::getModuleInfo() const { return moduleInfo; }
 
+const pe::ImageView &IATBuilder::getImageView() const { return imageView; }
+
 bool IATBuilder::rebuild(std::vector<std::uint8_t> &image) {
 
+  imageView = pe::ImageView(image);
+
   addOriginalImports(image);
 
   resolveImports(image);
 
   const auto originalImportDirVA =
-      pe::getOptionalHeader64(image.data())->ImportDirectory.VirtualAddress;
+      imageView.getOptionalHeader()->ImportDirectory.VirtualAddress;
 
-  rebuildImportDir(image);
+  // both new sections are sized before anything is written, so that the
+  // image only grows once and the sections are written in place.
+  const auto layout = planSections(image.size());
+  image.resize(layout.ImageSize);
+
+  const auto optionalHeader = pe::getOptionalHeader64(image.data());
 
-  applyPatches(image, originalImportDirVA);
+  SectionBuilder dataScn(
+      layout.Data.Offset, layout.Data.RVA, optionalHeader->SectionAlignment,
+      optionalHeader->FileAlignment,
+      std::span(image).subspan(layout.Data.Offset, layout.Data.FileSize));
+
+  SectionBuilder codeScn(
+      layout.Code.Offset, layout.Code.RVA, optionalHeader->SectionAlignment,
+      optionalHeader->FileAlignment,
+      std::span(image).subspan(layout.Code.Offset, layout.Code.FileSize));
+
+  if (!rebuildImportDir(image, dataScn)) {
+    LOG_ERROR("import directory does not fit the planned section.");
+    return false;
+  }
+
+  // the image has grown and gained the import section.
+  imageView = pe::ImageView(image);
+
+  if (!applyPatches(image, codeScn, originalImportDirVA)) {
+    LOG_ERROR("patches do not fit the planned code section.");
+    return false;
+  }
 
   updateHeaders(image);
 
+  imageView = pe::ImageView(image);
+
   return true;
 }
 
 IATBuilder::ImportFunction::ImportFunction(
-    std::variant<std::string, std::uint16_t> name)
+    std::variant<InternedString, std::uint16_t> name)
     : name(std::move(name)), redirectStubRVA(std::nullopt) {}
 
 IATBuilder::ImportFunction
-IATBuilder::ImportFunction::fromName(std::string name) {
-  return ImportFunction(std::move(name));
+IATBuilder::ImportFunction::fromName(InternedString name) {
+  return ImportFunction(name);
 }
 
 IATBuilder::ImportFunction
@@ -62,7 +151,7 @@ IATBuilder::ImportFunction::fromOrdinal(const std::uint16_t ordinal) {
   return ImportFunction(ordinal);
 }
 
-const std::variant<std::string, std::uint16_t> &
+const std::variant<InternedString, std::uint16_t> &
 IATBuilder::ImportFunction::getName() const {
   return name;
 }
@@ -76,11 +165,15 @@ void IATBuilder::ImportFunction::setRedirectStub(const std::uint32_t &rva) {
   redirectStubRVA = rva;
 }
 
-IATBuilder::ImportLibrary::ImportLibrary(std::string library,
-                                         std::vector<ImportFunction> functions)
-    : library(std::move(library)), functions(std::move(functions)) {}
+IATBuilder::ImportLibrary::ImportLibrary(
+    InternedString library, std::vector<ImportFunction> initialFunctions)
+    : library(library) {
+  for (const auto &function : initialFunctions) {
+    addFunction(function);
+  }
+}
 
-const std::string &IATBuilder::ImportLibrary::getName() const {
+const InternedString &IATBuilder::ImportLibrary::getName() const {
   return library;
 }
 
@@ -106,32 +199,38 @@ IATBuilder::ImportLibrary::getFunctionByName(std::string_view name) const {
 
 const IATBuilder::ImportFunction *
 IATBuilder::ImportLibrary::getFunctionByOrdinal(std::uint16_t ordinal) const {
-  for (const auto &func : functions) {
-    if (func.getName().index() == 1 && std::get<1>(func.getName()) == ordinal) {
-      return &func;
-    }
+  return getFunctionByName(
+      std::variant<InternedString, std::uint16_t>(ordinal));
+}
+
+const IATBuilder::ImportFunction *IATBuilder::ImportLibrary::getFunctionByName(
+    const std::variant<InternedString, std::uint16_t> &name) const {
+  if (const auto found = functionsByName.find(name);
+      found != functionsByName.end()) {
+    return &functions[found->second];
   }
   return nullptr;
 }
 
-const IATBuilder::ImportFunction *IATBuilder::ImportLibrary::getFunctionByName(
-    const std::variant<std::string, std::uint16_t> &name) const {
-  for (const auto &func : functions) {
-    if (func.getName() == name) {
-      return &func;
-    }
+IATBuilder::ImportFunction *IATBuilder::ImportLibrary::getFunctionByName(
+    const std::variant<InternedString, std::uint16_t> &name) {
+  if (const auto found = functionsByName.find(name);
+      found != functionsByName.end()) {
+    return &functions[found->second];
   }
   return nullptr;
 }
 
-void IATBuilder::ImportLibrary::addFunction(const ImportFunction &function) {
-  for (const auto &func : functions) {
-    if (func.getName() == function.getName()) {
-      return;
-    }
+std::uint32_t
+IATBuilder::ImportLibrary::addFunction(const ImportFunction &function) {
+  const auto [found, inserted] = functionsByName.try_emplace(
+      function.getName(), static_cast<std::uint32_t>(functions.size()));
+
+  if (inserted) {
+    functions.emplace_back(function);
   }
 
-  functions.emplace_back(function);
+  return found->second;
 }
 
 const std::vector<IATBuilder::ImportLibrary> &IATBuilder::getImports() const {
@@ -175,16 +274,10 @@ ImportDirLayout IATBuilder::getImportDirLayout() const {
 
 const IATBuilder::ImportFunction *IATBuilder::findImportFunction(
     const std::string_view library,
-    const std::variant<std::string, std::uint16_t> &function) const {
+    const std::variant<InternedString, std::uint16_t> &function) const {
 
-  for (const auto &imp : imports) {
-    if (compareLibraryName(imp.getName(), library)) {
-      for (const auto &func : imp.getFunctions()) {
-        if (func.getName() == function) {
-          return &func;
-        }
-      }
-    }
+  if (const auto importLibrary = findImportLibrary(library)) {
+    return importLibrary->getFunctionByName(function);
   }
 
   return nullptr;
@@ -192,25 +285,71 @@ const IATBuilder::ImportFunction *IATBuilder::findImportFunction(
 
 IATBuilder::ImportFunction *IATBuilder::findImportFunction(
     const std::string_view library,
-    const std::variant<std::string, std::uint16_t> &function) {
+    const std::variant<InternedString, std::uint16_t> &function) {
 
-  for (auto &imp : imports) {
-    if (compareLibraryName(imp.getName(), library)) {
-      for (auto &func : imp.getFunctions()) {
-        if (func.getName() == function) {
-          return &func;
-        }
-      }
-    }
+  if (const auto importLibrary = findImportLibrary(library)) {
+    return importLibrary->getFunctionByName(function);
+  }
+
+  return nullptr;
+}
+
+const IATBuilder::ImportFunction *
+IATBuilder::findImportFunction(const ResolvedImport &import) const {
+
+  if (const auto slot = findImportSlot(import)) {
+    return &imports[slot->Library].getFunctions()[slot->Function];
   }
 
   return nullptr;
 }
 
+IATBuilder::ImportFunction *
+IATBuilder::findImportFunction(const ResolvedImport &import) {
+
+  if (const auto slot = findImportSlot(import)) {
+    return &imports[slot->Library].getFunctions()[slot->Function];
+  }
+
+  return nullptr;
+}
+
+std::optional<IATBuilder::ImportSlot>
+IATBuilder::findImportSlot(const ResolvedImport &import) const {
+
+  if (const auto found = importsByHandle.find(import);
+      found != importsByHandle.end()) {
+    return found->second;
+  }
+
+  return std::nullopt;
+}
+
+std::optional<std::uint32_t>
+IATBuilder::getImportThunk(const ImportSlot &slot) const {
+
+  if (slot.Library >= importThunkRVAs.size()) {
+    return std::nullopt;
+  }
+
+  return importThunkRVAs[slot.Library] +
+         static_cast<std::uint32_t>(sizeof(pe::ImageThunkData64)) *
+             slot.Function;
+}
+
+std::optional<std::uint32_t>
+IATBuilder::getImportThunk(const ResolvedImport &import) const {
+
+  if (const auto slot = findImportSlot(import)) {
+    return getImportThunk(*slot);
+  }
+
+  return std::nullopt;
+}
+
 void IATBuilder::addOriginalImports(const std::vector<std::uint8_t> &image) {
 
-  const auto &importDir =
-      pe::getOptionalHeader64(image.data())->ImportDirectory;
+  const auto &importDir = imageView.getOptionalHeader()->ImportDirectory;
 
   if (importDir.VirtualAddress == 0 || importDir.Size == 0) {
     return;
@@ -239,7 +378,8 @@ void IATBuilder::addOriginalImports(const std::vector<std::uint8_t> &image) {
             reinterpret_cast<const pe::ImageImportByName *>(
                 image.data() + originalFirstThunk->u1.AddressOfData);
 
-        addImport(libraryName, ImportFunction::fromName(importByName->Name));
+        addImport(libraryName,
+                  ImportFunction::fromName(InternedString(importByName->Name)));
       }
 
       ++originalFirstThunk;
@@ -255,8 +395,11 @@ void IATBuilder::resolveImports(const std::vector<std::uint8_t> &image) {
 
   for (const auto &resolver : iatResolvers) {
     if (resolver->resolve(image)) {
-      for (const auto &[library, function] : resolver->getImports()) {
-        addImport(library, ImportFunction::fromName(function));
+      for (const auto &import : resolver->getImports()) {
+        if (!addImport(import)) {
+          LOG_WARN("skipping import of export {} from module {}.",
+                   import.ExportIndex, import.ModuleIndex);
+        }
       }
     }
   }
@@ -264,22 +407,58 @@ void IATBuilder::resolveImports(const std::vector<std::uint8_t> &image) {
   LOG_WRITE("\n");
 }
 
-void IATBuilder::rebuildImportDir(std::vector<std::uint8_t> &image) const {
-
-  LOG_INFO("rebuilding import address table...");
+IATBuilder::RebuildLayout
+IATBuilder::planSections(const std::size_t imageSize) const {
 
-  const auto optionalHeader = pe::getOptionalHeader64(image.data());
+  const auto optionalHeader = imageView.getOptionalHeader();
   const auto sectionAlignment = optionalHeader->SectionAlignment;
   const auto fileAlignment = optionalHeader->FileAlignment;
 
-  SectionBuilder section(align<std::uint32_t>(image.size(), fileAlignment),
-                         align<std::uint32_t>(image.size(), sectionAlignment),
-                         sectionAlignment, fileAlignment);
+  // one redirect stub per import, and whatever the resolvers add.
+  std::size_t codeSize = 0;
+  for (const auto &imp : imports) {
+    codeSize += RedirectStubSize * imp.getFunctions().size();
+  }
+
+  for (const auto &resolver : iatResolvers) {
+    codeSize += resolver->getPatchCodeSize();
+  }
+
+  RebuildLayout layout{};
+
+  // the same placement the sections would get when appended one at a time.
+  layout.Data.Offset = align<std::uint32_t>(imageSize, fileAlignment);
+  layout.Data.RVA = align<std::uint32_t>(imageSize, sectionAlignment);
+  layout.Data.FileSize =
+      align<std::uint32_t>(getImportDirLayout().Size, fileAlignment);
+
+  const std::size_t dataEnd =
+      static_cast<std::size_t>(layout.Data.Offset) + layout.Data.FileSize;
+
+  layout.Code.Offset = align<std::uint32_t>(dataEnd, fileAlignment);
+  layout.Code.RVA = align<std::uint32_t>(dataEnd, sectionAlignment);
+  layout.Code.FileSize = align<std::uint32_t>(codeSize, fileAlignment);
+
+  layout.ImageSize =
+      static_cast<std::size_t>(layout.Code.Offset) + layout.Code.FileSize;
+
+  return layout;
+}
+
+bool IATBuilder::rebuildImportDir(std::vector<std::uint8_t> &image,
+                                  SectionBuilder &section) {
+
+  LOG_INFO("rebuilding import address table...");
+
+  const auto optionalHeader = pe::getOptionalHeader64(image.data());
 
   section.addCharacteristics(IMAGE_SCN_CNT_INITIALIZED_DATA |
                              IMAGE_SCN_MEM_READ | IMAGE_SCN_MEM_WRITE);
 
-  constructImportDir(section);
+  if (!constructImportDir(section)) {
+    return false;
+  }
+
   const auto importDirSize = section.getRawSize();
 
   const auto sectionHeader = appendImageSectionHeader(image.data());
@@ -296,33 +475,31 @@ void IATBuilder::rebuildImportDir(std::vector<std::uint8_t> &image) const {
 
   section.finalize();
 
-  image.resize(section.getOffset());
-  image.insert(image.end(), section.getData().begin(), section.getData().end());
+  return true;
 }
 
-void IATBuilder::applyPatches(std::vector<std::uint8_t> &image,
+bool IATBuilder::applyPatches(std::vector<std::uint8_t> &image,
+                              SectionBuilder &codeScn,
                               std::uint32_t origImportDirVA) {
 
-  const auto optionalHeader = pe::getOptionalHeader64(image.data());
-  const auto sectionAlignment = optionalHeader->SectionAlignment;
-  const auto fileAlignment = optionalHeader->FileAlignment;
-
-  SectionBuilder codeScn(align<std::uint32_t>(image.size(), fileAlignment),
-                         align<std::uint32_t>(image.size(), sectionAlignment),
-                         sectionAlignment, fileAlignment);
-
   codeScn.addCharacteristics(IMAGE_SCN_CNT_INITIALIZED_DATA |
                              IMAGE_SCN_CNT_CODE | IMAGE_SCN_MEM_READ |
                              IMAGE_SCN_MEM_EXECUTE);
 
-  buildRedirectStubs(image, codeScn);
+  // the original IAT is only pointed at the stubs once all of them have
+  // been written.
+  if (!buildRedirectStubs(codeScn)) {
+    return false;
+  }
 
   redirectOriginalIAT(image, origImportDirVA);
 
   LOG_INFO("applying patches...");
 
   for (const auto &resolver : iatResolvers) {
-    resolver->applyPatches(image, codeScn);
+    if (!resolver->applyPatches(image, codeScn)) {
+      return false;
+    }
   }
 
   const auto sectionHeader = appendImageSectionHeader(image.data());
@@ -335,79 +512,44 @@ void IATBuilder::applyPatches(std::vector<std::uint8_t> &image,
 
   codeScn.finalize();
 
-  image.resize(codeScn.getOffset());
-  image.insert(image.end(), codeScn.getData().begin(), codeScn.getData().end());
+  return true;
 }
 
-void IATBuilder::buildRedirectStubs(const std::vector<std::uint8_t> &image,
-                                    SectionBuilder &codeScn) {
-
-  const auto ntHeaders = pe::getNtHeaders(image.data());
-  const auto &newImportDir = ntHeaders->OptionalHeader64.ImportDirectory;
+bool IATBuilder::buildRedirectStubs(SectionBuilder &codeScn) {
 
   LOG_INFO("building IAT redirect stubs...");
 
-  for (auto importDesc = reinterpret_cast<const pe::ImageImportDescriptor *>(
-           image.data() +
-           *ntHeaders->rvaToFileOffset(newImportDir.VirtualAddress));
-       importDesc->Name != 0; importDesc++) {
-
-    const auto libraryName = reinterpret_cast<const char *>(
-        image.data() + *ntHeaders->rvaToFileOffset(importDesc->Name));
-
-    auto originalFirstThunk = reinterpret_cast<const pe::ImageThunkData64 *>(
-        image.data() +
-        *ntHeaders->rvaToFileOffset(importDesc->OriginalFirstThunk));
-
-    auto firstThunk = reinterpret_cast<const pe::ImageThunkData64 *>(
-        image.data() + *ntHeaders->rvaToFileOffset(importDesc->FirstThunk));
+  for (std::size_t i = 0; i < imports.size(); i++) {
+    auto &functions = imports[i].getFunctions();
 
-    for (; originalFirstThunk->u1.AddressOfData != 0;
-         ++originalFirstThunk, ++firstThunk) {
+    for (std::size_t j = 0; j < functions.size(); j++) {
 
       // jmp    QWORD PTR [rip+offset]
-      std::uint8_t stub[] = {0xff, 0x25, 0x00, 0x00, 0x00, 0x00};
+      std::uint8_t stub[RedirectStubSize] = {0xff, 0x25, 0x00,
+                                             0x00, 0x00, 0x00};
 
       const auto stubRVA = codeScn.getRVA() + codeScn.getRawSize();
 
       const std::uint32_t addressOfDataRVA =
-          *ntHeaders->fileOffsetToRVA(reinterpret_cast<const std::uint8_t *>(
-                                          &firstThunk->u1.AddressOfData) -
-                                      image.data());
+          importThunkRVAs[i] + sizeof(pe::ImageThunkData64) * j;
 
       *reinterpret_cast<std::int32_t *>(&stub[2]) = static_cast<std::int32_t>(
           addressOfDataRVA - (stubRVA + sizeof(stub)));
 
-      codeScn.append(stub);
-
-      if (IMAGE_SNAP_BY_ORDINAL64(originalFirstThunk->u1.Ordinal)) {
-        if (const auto importFunction = findImportFunction(
-                libraryName, static_cast<std::uint16_t>(IMAGE_ORDINAL64(
-                                 originalFirstThunk->u1.Ordinal)))) {
-
-          importFunction->setRedirectStub(stubRVA);
-        }
-      } else {
-        const auto importByName =
-            reinterpret_cast<const pe::ImageImportByName *>(
-                image.data() + *ntHeaders->rvaToFileOffset(
-                                   originalFirstThunk->u1.AddressOfData));
-
-        if (const auto importFunction =
-                findImportFunction(libraryName, importByName->Name)) {
-
-          importFunction->setRedirectStub(stubRVA);
-        }
+      if (!codeScn.append(stub)) {
+        return false;
       }
+
+      functions[j].setRedirectStub(stubRVA);
     }
   }
+
+  return true;
 }
 
 void IATBuilder::redirectOriginalIAT(std::vector<std::uint8_t> &image,
                                      std::uint32_t origImportDirVA) const {
 
-  const auto ntHeaders = pe::getNtHeaders(image.data());
-
   LOG_INFO("redirecting original IAT...");
 
   for (auto importDesc = reinterpret_cast<pe::ImageImportDescriptor *>(
@@ -436,10 +578,10 @@ void IATBuilder::redirectOriginalIAT(std::vector<std::uint8_t> &image,
       } else {
         const auto importByName = reinterpret_cast<pe::ImageImportByName *>(
             image.data() +
-            *ntHeaders->rvaToFileOffset(originalFirstThunk->u1.AddressOfData));
+            *imageView.rvaToFileOffset(originalFirstThunk->u1.AddressOfData));
 
-        if (const auto importFunction =
-                findImportFunction(libraryName, importByName->Name)) {
+        if (const auto importFunction = findImportFunction(
+                libraryName, InternedString(importByName->Name))) {
 
           firstThunk->u1.Function =
               moduleInfo->getImageBase() + *importFunction->getRedirectStub();
@@ -449,17 +591,21 @@ void IATBuilder::redirectOriginalIAT(std::vector<std::uint8_t> &image,
   }
 }
 
-bool IATBuilder::constructImportDir(SectionBuilder &dataScn) const {
+bool IATBuilder::constructImportDir(SectionBuilder &dataScn) {
 
   const auto importDirLayout = getImportDirLayout();
 
   const std::uint32_t importDirRVA = dataScn.getRVA() + dataScn.getRawSize();
 
-  dataScn.getMutableData().resize(
-      static_cast<std::size_t>(dataScn.getRawSize()) + importDirLayout.Size, 0);
+  std::uint8_t *importDirData = dataScn.reserve(importDirLayout.Size);
+  if (!importDirData) {
+    return false;
+  }
+
+  std::memset(importDirData, 0, importDirLayout.Size);
 
-  std::uint8_t *importDirData =
-      dataScn.getMutableData().data() + (importDirRVA - dataScn.getRVA());
+  importThunkRVAs.clear();
+  importThunkRVAs.reserve(imports.size());
 
   std::size_t functionIdx = 0;
   std::size_t libraryNameOffset = importDirLayout.LibraryNameOffset;
@@ -481,6 +627,8 @@ bool IATBuilder::constructImportDir(SectionBuilder &dataScn) const {
     importDesc->FirstThunk = importDirRVA + importDirLayout.FirstThunkOffset +
                              sizeof(pe::ImageThunkData64) * (i + functionIdx);
 
+    importThunkRVAs.push_back(importDesc->FirstThunk);
+
     std::memcpy(importDirData + libraryNameOffset, imp.getName().data(),
                 imp.getName().size() + sizeof('\0'));
 
@@ -9,6 +9,21 @@ namespace dmadump {
 IATResolver::IATResolver(IATBuilder &iatBuilder)
     : iatBuilder(iatBuilder) {}
 
+const pe::ImageView &
+IATResolver::getImageView(const std::vector<std::uint8_t> &image) {
+
+  if (const auto &imageView = iatBuilder.getImageView();
+      imageView.getData().data() == image.data() &&
+      imageView.getData().size() == image.size()) {
+    return imageView;
+  }
+
+  ownImageView = pe::ImageView(image);
+  return ownImageView;
+}
+
+std::size_t IATResolver::getPatchCodeSize() const { return 0; }
+
 std::uint64_t IATResolver::getLowestModuleStartAddress() const {
   std::uint64_t result = std::numeric_limits<std::uint64_t>::max();
 
@@ -32,28 +47,4 @@ std::uint64_t IATResolver::getHighestModuleEndAddress() const {
 
   return result;
 }
-
-std::vector<std::uint32_t> IATResolver::findDirectCalls(
-    const std::uint8_t *searchBegin, const std::uint8_t *searchEnd,
-    const std::uint32_t searchRVA, const std::uint32_t functionPtrRVA) {
-
-  std::vector<std::uint32_t> result;
-
-  for (auto it = searchBegin; it != searchEnd - 6; ++it) {
-
-    if (it[0] == 0xff && it[1] == 0x15) {
-      const std::int32_t ripRelTarget =
-          *reinterpret_cast<const std::int32_t *>(&it[2]);
-
-      const std::uint64_t targetRVA =
-          it - searchBegin + searchRVA + ripRelTarget + 6;
-
-      if (targetRVA == functionPtrRVA) {
-        result.push_back(it - searchBegin + searchRVA);
-      }
-    }
-  }
-
-  return result;
-}
 } // namespace dmadump
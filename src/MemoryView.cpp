@@ -0,0 +1,93 @@
+#include <dmadump/MemoryView.hpp>
+#include <dmadump/PageCache.hpp>
+#include <algorithm>
+#include <utility>
+
+namespace dmadump {
+MemoryView::MemoryView(const std::uint64_t va) : va(va) {}
+
+MemoryView::MemoryView(MemoryView &&other) noexcept
+    : va(std::exchange(other.va, 0)), size(std::exchange(other.size, 0)),
+      segments(std::move(other.segments)),
+      pageCache(std::exchange(other.pageCache, nullptr)),
+      pinnedPages(std::move(other.pinnedPages)),
+      storage(std::move(other.storage)) {}
+
+MemoryView &MemoryView::operator=(MemoryView &&other) noexcept {
+  if (this != &other) {
+    release();
+    va = std::exchange(other.va, 0);
+    size = std::exchange(other.size, 0);
+    segments = std::move(other.segments);
+    pageCache = std::exchange(other.pageCache, nullptr);
+    pinnedPages = std::move(other.pinnedPages);
+    storage = std::move(other.storage);
+  }
+  return *this;
+}
+
+MemoryView::~MemoryView() { release(); }
+
+std::uint64_t MemoryView::getVA() const { return va; }
+
+std::uint32_t MemoryView::getSize() const { return size; }
+
+bool MemoryView::empty() const { return size == 0; }
+
+const std::vector<std::span<const std::uint8_t>> &
+MemoryView::getSegments() const {
+  return segments;
+}
+
+bool MemoryView::read(std::uint32_t offset, void *buffer,
+                      std::uint32_t size) const {
+  if (offset > this->size || size > this->size - offset) {
+    return false;
+  }
+
+  auto dest = static_cast<std::uint8_t *>(buffer);
+  for (const auto &segment : segments) {
+    if (size == 0) {
+      break;
+    }
+
+    if (offset >= segment.size()) {
+      offset -= static_cast<std::uint32_t>(segment.size());
+      continue;
+    }
+
+    const auto count =
+        std::min<std::uint32_t>(size, segment.size() - offset);
+    dest = std::copy_n(segment.data() + offset, count, dest);
+    size -= count;
+    offset = 0;
+  }
+
+  return true;
+}
+
+void MemoryView::append(const std::uint8_t *data, const std::uint32_t size) {
+  if (!segments.empty() &&
+      segments.back().data() + segments.back().size() == data) {
+    segments.back() = {segments.back().data(), segments.back().size() + size};
+  } else {
+    segments.emplace_back(data, size);
+  }
+
+  this->size += size;
+}
+
+void MemoryView::release() {
+  if (pageCache) {
+    for (const auto page : pinnedPages) {
+      pageCache->unpin(page);
+    }
+    pageCache = nullptr;
+  }
+
+  pinnedPages.clear();
+  segments.clear();
+  storage.reset();
+  size = 0;
+}
+} // namespace dmadump
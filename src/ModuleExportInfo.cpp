@@ -1,13 +1,12 @@
 #include <dmadump/ModuleExportInfo.hpp>
-#include <utility>
 
 namespace dmadump {
-ModuleExportInfo::ModuleExportInfo(std::string name,
+ModuleExportInfo::ModuleExportInfo(const std::string_view name,
                                    const std::uint16_t ordinal,
                                    const std::uint32_t rva)
-    : name(std::move(name)), ordinal(ordinal), rva(rva) {}
+    : name(name), ordinal(ordinal), rva(rva) {}
 
-const std::string &ModuleExportInfo::getName() const { return name; }
+const InternedString &ModuleExportInfo::getName() const { return name; }
 
 std::uint16_t ModuleExportInfo::getOrdinal() const { return ordinal; }
 
@@ -1,6 +1,11 @@
 #include <dmadump/ModuleInfo.hpp>
+#include <dmadump/Dumper.hpp>
+#include <dmadump/Logging.hpp>
 #include <dmadump/Utils.hpp>
+#include <algorithm>
 #include <filesystem>
+#include <limits>
+#include <numeric>
 #include <vector>
 
 namespace dmadump {
@@ -8,9 +13,39 @@ ModuleInfo::ModuleInfo(const std::string &name,
                        const std::filesystem::path &filePath,
                        const std::uint64_t imageBase,
                        const std::uint32_t imageSize,
-                       const std::vector<ModuleExportInfo> &exports)
+                       const std::vector<ModuleExportInfo> &exports,
+                       Dumper *dumper)
     : name(name), libraryID(simplifyLibraryName(name)), filePath(filePath),
-      imageBase(imageBase), imageSize(imageSize), exports(exports) {}
+      imageBase(imageBase), imageSize(imageSize), dumper(dumper),
+      exports(exports), exportsLoaded(dumper == nullptr) {
+  buildExportIndexes();
+}
+
+ModuleInfo::ModuleInfo(const ModuleInfo &other)
+    : name(other.name), libraryID(other.libraryID), filePath(other.filePath),
+      imageBase(other.imageBase), imageSize(other.imageSize),
+      dumper(other.dumper) {
+  std::lock_guard lock(other.exportsMutex);
+  exports = other.exports;
+  exportsLoaded = other.exportsLoaded.load();
+  buildExportIndexes();
+}
+
+ModuleInfo::ModuleInfo(ModuleInfo &&other) noexcept
+    : name(std::move(other.name)), libraryID(std::move(other.libraryID)),
+      filePath(std::move(other.filePath)), imageBase(other.imageBase),
+      imageSize(other.imageSize), dumper(other.dumper) {
+  std::lock_guard lock(other.exportsMutex);
+  exports = std::move(other.exports);
+  exportsLoaded = other.exportsLoaded.load();
+
+  // the name index views interned strings, which stay valid across the move,
+  // so the indexes are taken over instead of being rebuilt.
+  exportsByRVA = std::move(other.exportsByRVA);
+  exportRVAs = std::move(other.exportRVAs);
+  exportsByName = std::move(other.exportsByName);
+  exportsByOrdinal = std::move(other.exportsByOrdinal);
+}
 
 const std::string &ModuleInfo::getName() const { return name; }
 
@@ -24,51 +59,121 @@ std::uint64_t ModuleInfo::getImageBase() const { return imageBase; }
 
 std::uint32_t ModuleInfo::getImageSize() const { return imageSize; }
 
+std::uint32_t ModuleInfo::getIndex() const { return index; }
+
 const std::vector<ModuleExportInfo> &ModuleInfo::getExports() const {
+  loadExports();
   return exports;
 }
 
+void ModuleInfo::loadExports() const {
+  if (exportsLoaded.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  std::lock_guard lock(exportsMutex);
+  if (exportsLoaded.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  std::vector<ModuleExportInfo> loadedExports;
+  if (!dumper->loadModuleEAT(*this, loadedExports)) {
+    LOG_WARN("failed to load EAT for module: {}", name);
+  }
+
+  exports.insert(exports.end(), std::make_move_iterator(loadedExports.begin()),
+                 std::make_move_iterator(loadedExports.end()));
+  buildExportIndexes();
+
+  exportsLoaded.store(true, std::memory_order_release);
+}
+
+bool ModuleInfo::areExportsLoaded() const {
+  return exportsLoaded.load(std::memory_order_acquire);
+}
+
 void ModuleInfo::addExport(const ModuleExportInfo &exportInfo) {
+  loadExports();
+
+  std::lock_guard lock(exportsMutex);
   exports.push_back(exportInfo);
+  buildExportIndexes();
 }
 
 const ModuleExportInfo *
 ModuleInfo::getExportByName(const std::string_view name) const {
-  for (const auto &exp : exports) {
-    if (exp.getName() == name) {
-      return &exp;
-    }
-  }
-  return nullptr;
+  loadExports();
+
+  const auto found = exportsByName.find(name);
+  return found != exportsByName.end() ? &exports[found->second] : nullptr;
 }
 
 const ModuleExportInfo *
 ModuleInfo::getExportByOrdinal(const std::uint32_t ordinal) const {
-  for (const auto &exp : exports) {
-    if (exp.getOrdinal() == ordinal) {
-      return &exp;
-    }
+  loadExports();
+
+  if (ordinal >= exportsByOrdinal.size() ||
+      exportsByOrdinal[ordinal] == NoExport) {
+    return nullptr;
   }
-  return nullptr;
+
+  return &exports[exportsByOrdinal[ordinal]];
 }
 
 const ModuleExportInfo *
 ModuleInfo::getExportByVA(const std::uint64_t va) const {
-  for (const auto &exp : exports) {
-    if (imageBase + exp.getRVA() == va) {
-      return &exp;
-    }
+  if (va < imageBase ||
+      va - imageBase > std::numeric_limits<std::uint32_t>::max()) {
+    return nullptr;
   }
-  return nullptr;
+
+  return getExportByRVA(static_cast<std::uint32_t>(va - imageBase));
 }
 
 const ModuleExportInfo *
 ModuleInfo::getExportByRVA(const std::uint32_t rva) const {
-  for (const auto &exp : exports) {
-    if (exp.getRVA() == rva) {
-      return &exp;
+  loadExports();
+
+  const auto found = std::ranges::lower_bound(exportRVAs, rva);
+  if (found == exportRVAs.end() || *found != rva) {
+    return nullptr;
+  }
+
+  return &exports[exportsByRVA[found - exportRVAs.begin()]];
+}
+
+void ModuleInfo::buildExportIndexes() const {
+  const auto exportCount = static_cast<std::uint32_t>(exports.size());
+
+  // every index keeps the first export with a given key, which is what the
+  // scans they replace returned.
+  exportsByRVA.resize(exportCount);
+  std::iota(exportsByRVA.begin(), exportsByRVA.end(), 0);
+  std::ranges::stable_sort(exportsByRVA, {}, [&](const std::uint32_t i) {
+    return exports[i].getRVA();
+  });
+
+  exportRVAs.resize(exportCount);
+  for (std::uint32_t i = 0; i < exportCount; i++) {
+    exportRVAs[i] = exports[exportsByRVA[i]].getRVA();
+  }
+
+  exportsByName.clear();
+  exportsByName.reserve(exportCount);
+  for (std::uint32_t i = 0; i < exportCount; i++) {
+    exportsByName.emplace(exports[i].getName(), i);
+  }
+
+  exportsByOrdinal.clear();
+  for (std::uint32_t i = 0; i < exportCount; i++) {
+    const std::uint16_t ordinal = exports[i].getOrdinal();
+    if (ordinal >= exportsByOrdinal.size()) {
+      exportsByOrdinal.resize(ordinal + 1, NoExport);
+    }
+
+    if (exportsByOrdinal[ordinal] == NoExport) {
+      exportsByOrdinal[ordinal] = i;
     }
   }
-  return nullptr;
 }
 } // namespace dmadump
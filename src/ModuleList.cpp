@@ -1,20 +1,27 @@
 #include <dmadump/ModuleList.hpp>
 #include <dmadump/Utils.hpp>
-#include <ranges>
+#include <algorithm>
 
 namespace dmadump {
 void ModuleList::addModule(ModuleInfo &&moduleInfo) {
   if (const std::string moduleID = moduleInfo.getLibraryID();
       !moduleMap.contains(moduleID)) {
-    moduleMap.emplace(moduleID,
-                      std::make_unique<ModuleInfo>(std::move(moduleInfo)));
+    const auto &added =
+        moduleMap
+            .emplace(moduleID,
+                     std::make_unique<ModuleInfo>(std::move(moduleInfo)))
+            .first->second;
+    addModuleEntry(added.get());
   }
 }
 
 void ModuleList::addModule(const ModuleInfo &moduleInfo) {
   if (const std::string &moduleID = moduleInfo.getLibraryID();
       !moduleMap.contains(moduleID)) {
-    moduleMap.emplace(moduleID, std::make_unique<ModuleInfo>(moduleInfo));
+    const auto &added =
+        moduleMap.emplace(moduleID, std::make_unique<ModuleInfo>(moduleInfo))
+            .first->second;
+    addModuleEntry(added.get());
   }
 }
 
@@ -35,19 +42,72 @@ ModuleList::getModuleByName(const std::string_view moduleName) const {
   return nullptr;
 }
 
+const ModuleInfo *
+ModuleList::getModuleByIndex(const std::uint32_t index) const {
+  return index < modules.size() ? modules[index] : nullptr;
+}
+
+std::uint32_t ModuleList::getModuleCount() const {
+  return static_cast<std::uint32_t>(modules.size());
+}
+
 const ModuleInfo *
 ModuleList::getModuleByAddress(const std::uint64_t address) const {
 
-  for (const auto &mod : std::views::values(moduleMap)) {
+  if (rangeBegins.empty()) {
+    return nullptr;
+  }
+
+  // find the last range that begins at or below the address. the loop runs a
+  // fixed number of times for a given size and the select compiles to a
+  // conditional move, so there is nothing to mispredict.
+  const std::uint64_t *first = rangeBegins.data();
+  for (std::size_t count = rangeBegins.size(); count > 1;) {
+    const std::size_t half = count / 2;
+    first = first[half] <= address ? first + half : first;
+    count -= half;
+  }
 
-    if (mod->getImageBase() && mod->getImageSize() &&
-        address >= mod->getImageBase() &&
-        address < mod->getImageBase() + mod->getImageSize()) {
+  if (address < *first) {
+    return nullptr;
+  }
 
-      return mod.get();
+  // without overlapping ranges this is the only range that is checked,
+  // otherwise walk back as long as an earlier range can still reach the
+  // address.
+  for (std::size_t index = first - rangeBegins.data() + 1;
+       index-- > 0 && rangeMaxEnds[index] > address;) {
+    if (address < rangeEnds[index]) {
+      return rangeModules[index];
     }
   }
 
   return nullptr;
 }
+
+void ModuleList::addModuleEntry(ModuleInfo *moduleInfo) {
+
+  moduleInfo->index = static_cast<std::uint32_t>(modules.size());
+  modules.push_back(moduleInfo);
+
+  if (!moduleInfo->getImageBase() || !moduleInfo->getImageSize()) {
+    return;
+  }
+
+  const auto position =
+      std::ranges::upper_bound(rangeBegins, moduleInfo->getImageBase()) -
+      rangeBegins.begin();
+
+  rangeBegins.insert(rangeBegins.begin() + position,
+                     moduleInfo->getImageBase());
+  rangeEnds.insert(rangeEnds.begin() + position,
+                   moduleInfo->getImageBase() + moduleInfo->getImageSize());
+  rangeModules.insert(rangeModules.begin() + position, moduleInfo);
+
+  rangeMaxEnds.resize(rangeEnds.size());
+  for (std::size_t i = position; i < rangeEnds.size(); i++) {
+    rangeMaxEnds[i] =
+        i != 0 ? std::max(rangeMaxEnds[i - 1], rangeEnds[i]) : rangeEnds[i];
+  }
+}
 } // namespace dmadump
@@ -101,4 +101,87 @@ ImageOptionalHeader64 *getOptionalHeader64(void *imageData) {
 const ImageOptionalHeader64 *getOptionalHeader64(const void *imageData) {
   return &getNtHeaders(imageData)->OptionalHeader64;
 }
+
+ImageView::ImageView(const std::span<const std::uint8_t> data)
+    : data(data), ntHeaders(pe::getNtHeaders(data.data())),
+      sections(ntHeaders->getSectionHeader(0), ntHeaders->getSectionCount()) {
+
+  std::vector<SectionRange> byRVA;
+  std::vector<SectionRange> byFileOffset;
+
+  for (const auto &section : sections) {
+    byRVA.push_back(
+        {section.VirtualAddress,
+         std::uint64_t{section.VirtualAddress} + section.SizeOfRawData,
+         section.PointerToRawData});
+    byFileOffset.push_back(
+        {section.PointerToRawData,
+         std::uint64_t{section.PointerToRawData} + section.SizeOfRawData,
+         section.VirtualAddress});
+  }
+
+  rvaRanges = buildRanges(std::move(byRVA), overlappingRVAs);
+  fileOffsetRanges =
+      buildRanges(std::move(byFileOffset), overlappingFileOffsets);
+}
+
+std::span<const std::uint8_t> ImageView::getData() const { return data; }
+
+const ImageNtHeaders *ImageView::getNtHeaders() const { return ntHeaders; }
+
+const ImageOptionalHeader64 *ImageView::getOptionalHeader() const {
+  return &ntHeaders->OptionalHeader64;
+}
+
+std::span<const ImageSectionHeader> ImageView::getSections() const {
+  return sections;
+}
+
+std::optional<std::uint32_t>
+ImageView::rvaToFileOffset(const std::uint32_t rva) const {
+  return overlappingRVAs ? ntHeaders->rvaToFileOffset(rva)
+                         : findInRanges(rvaRanges, rva);
+}
+
+std::optional<std::uint32_t>
+ImageView::fileOffsetToRVA(const std::uint32_t fileOffset) const {
+  return overlappingFileOffsets ? ntHeaders->fileOffsetToRVA(fileOffset)
+                                : findInRanges(fileOffsetRanges, fileOffset);
+}
+
+std::vector<ImageView::SectionRange>
+ImageView::buildRanges(std::vector<SectionRange> ranges, bool &overlapping) {
+
+  std::erase_if(ranges, [](const SectionRange &range) {
+    return range.End <= range.Begin;
+  });
+
+  std::ranges::sort(ranges, {}, &SectionRange::Begin);
+
+  overlapping = false;
+  for (std::size_t i = 1; i < ranges.size(); i++) {
+    overlapping |= ranges[i].Begin < ranges[i - 1].End;
+  }
+
+  return ranges;
+}
+
+std::optional<std::uint32_t>
+ImageView::findInRanges(const std::vector<SectionRange> &ranges,
+                        const std::uint32_t value) {
+
+  // the last range that begins at or before the value.
+  const auto found = std::ranges::upper_bound(ranges, value, {},
+                                              &SectionRange::Begin);
+  if (found == ranges.begin()) {
+    return std::nullopt;
+  }
+
+  const auto &range = *std::prev(found);
+  if (value >= range.End) {
+    return std::nullopt;
+  }
+
+  return range.Target + (value - range.Begin);
+}
 } // namespace dmadump::pe
@@ -0,0 +1,214 @@
+#include <dmadump/PageCache.hpp>
+#include <algorithm>
+
+namespace dmadump {
+PageCache::PageCache(const std::size_t capacity)
+    : maxFrames(std::max<std::size_t>(capacity / PageSize, 1)) {}
+
+const std::uint8_t *PageCache::find(const std::uint64_t pageVA) {
+
+  std::uint32_t frame;
+
+  // sequential small reads keep hitting the same page, skip the table walk.
+  if (pageVA == lastPageVA && lastFrame != InvalidFrame) {
+    frame = lastFrame;
+  } else {
+    frame = findFrame(pageVA);
+    if (frame == InvalidFrame) {
+      ++statistics.Misses;
+      return nullptr;
+    }
+
+    lastPageVA = pageVA;
+    lastFrame = frame;
+  }
+
+  ++statistics.Hits;
+  frames[frame].Referenced = true;
+
+  return getFrameData(frame);
+}
+
+bool PageCache::contains(const std::uint64_t pageVA) const {
+  return findFrame(pageVA) != InvalidFrame;
+}
+
+std::uint8_t *PageCache::insert(const std::uint64_t pageVA) {
+
+  std::uint64_t &entry = getIndexEntry(pageVA);
+
+  std::uint32_t frame;
+  if (entry) {
+    // either the page itself or a non-canonical alias of it, which simply
+    // takes over the frame.
+    frame = static_cast<std::uint32_t>(entry) - 1;
+  } else {
+    frame = allocateFrame();
+    if (frame == InvalidFrame) {
+      return nullptr;
+    }
+  }
+
+  entry = makeIndexEntry(pageVA, frame);
+  frames[frame].PageVA = pageVA;
+  frames[frame].Referenced = true;
+
+  lastPageVA = pageVA;
+  lastFrame = frame;
+
+  return getFrameData(frame);
+}
+
+const std::uint8_t *PageCache::pin(const std::uint64_t pageVA) {
+
+  const std::uint32_t frame = findFrame(pageVA);
+  if (frame == InvalidFrame) {
+    return nullptr;
+  }
+
+  if (frames[frame].PinCount++ == 0) {
+    ++pinnedFrames;
+  }
+
+  return getFrameData(frame);
+}
+
+void PageCache::unpin(const std::uint64_t pageVA) {
+
+  const std::uint32_t frame = findFrame(pageVA);
+  if (frame != InvalidFrame && frames[frame].PinCount != 0 &&
+      --frames[frame].PinCount == 0) {
+    --pinnedFrames;
+  }
+}
+
+void PageCache::clear() {
+  slabs.clear();
+  frames.clear();
+  index = {};
+  lastFrame = InvalidFrame;
+  clockHand = 0;
+  pinnedFrames = 0;
+  statistics = {};
+}
+
+std::size_t PageCache::getCapacity() const { return maxFrames * PageSize; }
+
+void PageCache::setCapacity(const std::size_t capacity) {
+  clear();
+  maxFrames = std::max<std::size_t>(capacity / PageSize, 1);
+}
+
+std::size_t PageCache::getSize() const { return frames.size() * PageSize; }
+
+std::size_t PageCache::getPinnedSize() const {
+  return pinnedFrames * PageSize;
+}
+
+const PageCache::Statistics &PageCache::getStatistics() const {
+  return statistics;
+}
+
+std::uint64_t PageCache::makeIndexEntry(const std::uint64_t pageVA,
+                                        const std::uint32_t frame) {
+  return (pageVA >> 48 << 32) | (static_cast<std::uint64_t>(frame) + 1);
+}
+
+std::uint64_t *PageCache::findIndexEntry(const std::uint64_t pageVA) const {
+
+  const auto &pdpt = index.Entries[(pageVA >> 39) & 0x1ff];
+  if (!pdpt) {
+    return nullptr;
+  }
+
+  const auto &pd = pdpt->Entries[(pageVA >> 30) & 0x1ff];
+  if (!pd) {
+    return nullptr;
+  }
+
+  const auto &pt = pd->Entries[(pageVA >> 21) & 0x1ff];
+  if (!pt) {
+    return nullptr;
+  }
+
+  return &pt->Entries[(pageVA >> 12) & 0x1ff];
+}
+
+std::uint64_t &PageCache::getIndexEntry(const std::uint64_t pageVA) {
+
+  auto &pdpt = index.Entries[(pageVA >> 39) & 0x1ff];
+  if (!pdpt) {
+    pdpt = std::make_unique<PageDirectoryPointerTable>();
+  }
+
+  auto &pd = pdpt->Entries[(pageVA >> 30) & 0x1ff];
+  if (!pd) {
+    pd = std::make_unique<PageDirectory>();
+  }
+
+  auto &pt = pd->Entries[(pageVA >> 21) & 0x1ff];
+  if (!pt) {
+    pt = std::make_unique<PageTable>();
+  }
+
+  return pt->Entries[(pageVA >> 12) & 0x1ff];
+}
+
+std::uint32_t PageCache::findFrame(const std::uint64_t pageVA) const {
+
+  const auto entry = findIndexEntry(pageVA);
+  if (!entry || static_cast<std::uint32_t>(*entry) == 0 ||
+      (*entry >> 32) != (pageVA >> 48)) {
+    return InvalidFrame;
+  }
+
+  return static_cast<std::uint32_t>(*entry) - 1;
+}
+
+std::uint8_t *PageCache::getFrameData(const std::uint32_t frame) const {
+  return slabs[frame / FramesPerSlab].get() +
+         static_cast<std::size_t>(frame % FramesPerSlab) * PageSize;
+}
+
+std::uint32_t PageCache::allocateFrame() {
+
+  if (frames.size() < maxFrames) {
+    const auto frame = static_cast<std::uint32_t>(frames.size());
+
+    if (frame % FramesPerSlab == 0) {
+      const std::size_t slabFrames =
+          std::min<std::size_t>(FramesPerSlab, maxFrames - frame);
+      slabs.push_back(
+          std::make_unique_for_overwrite<std::uint8_t[]>(slabFrames * PageSize));
+    }
+
+    frames.push_back({0, false, 0});
+    return frame;
+  }
+
+  // give every referenced frame a second chance before evicting it, and
+  // never evict a pinned frame. the first pass clears every referenced bit,
+  // so only pinned frames are left if the second pass finds nothing.
+  std::size_t visited = 0;
+  while (frames[clockHand].Referenced || frames[clockHand].PinCount != 0) {
+    if (++visited > 2 * frames.size()) {
+      return InvalidFrame;
+    }
+
+    frames[clockHand].Referenced = false;
+    clockHand = (clockHand + 1) % frames.size();
+  }
+
+  const std::uint32_t frame = clockHand;
+  clockHand = (clockHand + 1) % frames.size();
+
+  *findIndexEntry(frames[frame].PageVA) = 0;
+  ++statistics.Evictions;
+
+  if (frame == lastFrame) {
+    lastFrame = InvalidFrame;
+  }
+
+  return frame;
+}
+} // namespace dmadump
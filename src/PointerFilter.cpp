@@ -0,0 +1,197 @@
+#include <dmadump/PointerFilter.hpp>
+#include <bit>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define DMADUMP_X86_64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// msvc allows every intrinsic in any function, gcc and clang have to be told
+// which functions may use avx2.
+#if defined(DMADUMP_X86_64) && (defined(__GNUC__) || defined(__clang__))
+#define DMADUMP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DMADUMP_TARGET_AVX2
+#endif
+
+namespace dmadump {
+PointerFilter::PointerFilter(const std::uint64_t low, const std::uint64_t high)
+    : PointerFilter(low, high, getBestKernel()) {}
+
+PointerFilter::PointerFilter(const std::uint64_t low, const std::uint64_t high,
+                             const Kernel kernel)
+    : low(low), width(high > low ? high - low : 0),
+      kernel(isSupported(kernel) ? kernel : Kernel::Scalar) {}
+
+void PointerFilter::filter(const std::span<const std::uint64_t> qwords,
+                           std::vector<std::uint32_t> &candidates) const {
+
+  if (width == 0) {
+    return;
+  }
+
+  switch (kernel) {
+  case Kernel::AVX2:
+    filterAVX2(qwords, candidates);
+    break;
+  case Kernel::SSE2:
+    filterSSE2(qwords, candidates);
+    break;
+  default:
+    filterScalar(qwords, 0, candidates);
+    break;
+  }
+}
+
+PointerFilter::Kernel PointerFilter::getKernel() const { return kernel; }
+
+PointerFilter::Kernel PointerFilter::getBestKernel() {
+  static const Kernel best = [] {
+    if (isSupported(Kernel::AVX2)) {
+      return Kernel::AVX2;
+    }
+    if (isSupported(Kernel::SSE2)) {
+      return Kernel::SSE2;
+    }
+    return Kernel::Scalar;
+  }();
+
+  return best;
+}
+
+bool PointerFilter::isSupported(const Kernel kernel) {
+#ifdef DMADUMP_X86_64
+  switch (kernel) {
+  case Kernel::AVX2: {
+#ifdef _MSC_VER
+    // avx2 also needs the OS to save the ymm registers.
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+      return false;
+    }
+
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) {
+      return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+  }
+  default:
+    // every x86-64 CPU has SSE2.
+    return true;
+  }
+#else
+  return kernel == Kernel::Scalar;
+#endif
+}
+
+void PointerFilter::filterScalar(const std::span<const std::uint64_t> qwords,
+                                 const std::size_t begin,
+                                 std::vector<std::uint32_t> &candidates) const {
+  for (std::size_t i = begin; i < qwords.size(); i++) {
+    if (contains(qwords[i])) {
+      candidates.push_back(static_cast<std::uint32_t>(i));
+    }
+  }
+}
+
+void PointerFilter::filterSSE2(const std::span<const std::uint64_t> qwords,
+                               std::vector<std::uint32_t> &candidates) const {
+#ifdef DMADUMP_X86_64
+  // SSE2 has no 64-bit compares, so the high dwords of 4 qwords are checked
+  // against the high dwords of the range first and only the qwords that pass
+  // are checked exactly.
+  const auto highLow = static_cast<std::uint32_t>(low >> 32);
+  const auto highSpan =
+      static_cast<std::uint32_t>((low + width - 1) >> 32) - highLow;
+
+  const __m128i signBit = _mm_set1_epi32(static_cast<int>(0x80000000));
+  const __m128i base = _mm_set1_epi32(static_cast<int>(highLow));
+  const __m128i bound =
+      _mm_xor_si128(_mm_set1_epi32(static_cast<int>(highSpan)), signBit);
+
+  std::size_t i = 0;
+  for (; i + 4 <= qwords.size(); i += 4) {
+    const __m128 a = _mm_castsi128_ps(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(&qwords[i])));
+    const __m128 b = _mm_castsi128_ps(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(&qwords[i + 2])));
+
+    const __m128i high =
+        _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+    // unsigned (high - highLow) > highSpan, with the sign flipped for the
+    // signed compare.
+    const __m128i outside = _mm_cmpgt_epi32(
+        _mm_xor_si128(_mm_sub_epi32(high, base), signBit), bound);
+
+    auto mask = static_cast<std::uint32_t>(
+        ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xf);
+
+    for (; mask != 0; mask &= mask - 1) {
+      const std::size_t index = i + std::countr_zero(mask);
+      if (contains(qwords[index])) {
+        candidates.push_back(static_cast<std::uint32_t>(index));
+      }
+    }
+  }
+
+  filterScalar(qwords, i, candidates);
+#else
+  filterScalar(qwords, 0, candidates);
+#endif
+}
+
+DMADUMP_TARGET_AVX2 void
+PointerFilter::filterAVX2(const std::span<const std::uint64_t> qwords,
+                          std::vector<std::uint32_t> &candidates) const {
+#ifdef DMADUMP_X86_64
+  // unsigned (qword - low) < width, with the sign flipped for the signed
+  // 64-bit compare. two vectors per iteration give one 8-bit mask.
+  const __m256i signBit =
+      _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000));
+  const __m256i base = _mm256_set1_epi64x(static_cast<long long>(low));
+  const __m256i bound = _mm256_xor_si256(
+      _mm256_set1_epi64x(static_cast<long long>(width)), signBit);
+
+  std::size_t i = 0;
+  for (; i + 8 <= qwords.size(); i += 8) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&qwords[i]));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&qwords[i + 4]));
+
+    const __m256i insideA = _mm256_cmpgt_epi64(
+        bound, _mm256_xor_si256(_mm256_sub_epi64(a, base), signBit));
+    const __m256i insideB = _mm256_cmpgt_epi64(
+        bound, _mm256_xor_si256(_mm256_sub_epi64(b, base), signBit));
+
+    auto mask = static_cast<std::uint32_t>(
+        _mm256_movemask_pd(_mm256_castsi256_pd(insideA)) |
+        _mm256_movemask_pd(_mm256_castsi256_pd(insideB)) << 4);
+
+    for (; mask != 0; mask &= mask - 1) {
+      candidates.push_back(
+          static_cast<std::uint32_t>(i + std::countr_zero(mask)));
+    }
+  }
+
+  filterScalar(qwords, i, candidates);
+#else
+  filterScalar(qwords, 0, candidates);
+#endif
+}
+
+bool PointerFilter::contains(const std::uint64_t qword) const {
+  return qword - low < width;
+}
+} // namespace dmadump
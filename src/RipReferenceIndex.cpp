@@ -0,0 +1,148 @@
+#include <dmadump/RipReferenceIndex.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <optional>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
+namespace dmadump {
+namespace {
+enum LeadByte : std::uint8_t { NoLead, LeadFF, LeadRexW };
+
+// the bytes that can start one of the instructions, FF or a REX prefix with
+// W set.
+constexpr auto LeadBytes = [] {
+  std::array<std::uint8_t, 256> table{};
+  table[0xff] = LeadFF;
+  for (std::size_t rex = 0x48; rex <= 0x4f; rex++) {
+    table[rex] = LeadRexW;
+  }
+  return table;
+}();
+
+// kind + 1 of FF /2 and FF /4 with a RIP-relative operand, by ModRM.
+constexpr auto GroupFFModRMs = [] {
+  std::array<std::uint8_t, 256> table{};
+  table[0x15] = static_cast<std::uint8_t>(RipReferenceKind::Call) + 1;
+  table[0x25] = static_cast<std::uint8_t>(RipReferenceKind::Jump) + 1;
+  return table;
+}();
+
+// kind + 1 of the opcodes after REX.W, which take the register from the
+// ModRM byte and are RIP-relative when mod is 00 and r/m is 101.
+constexpr auto RexWOpcodes = [] {
+  std::array<std::uint8_t, 256> table{};
+  table[0x8b] = static_cast<std::uint8_t>(RipReferenceKind::Load) + 1;
+  table[0x8d] = static_cast<std::uint8_t>(RipReferenceKind::Address) + 1;
+  return table;
+}();
+
+constexpr bool isRipRelative(const std::uint8_t modrm) {
+  return (modrm & 0xc7) == 0x05;
+}
+
+std::optional<RipReference> decode(const std::span<const std::uint8_t> code,
+                                   const std::size_t offset) {
+  const std::uint8_t *const bytes = code.data() + offset;
+  const std::size_t available = code.size() - offset;
+
+  RipReference reference{};
+
+  switch (LeadBytes[bytes[0]]) {
+  case LeadFF:
+    if (available < 6 || !GroupFFModRMs[bytes[1]]) {
+      return std::nullopt;
+    }
+    reference.Kind = static_cast<RipReferenceKind>(GroupFFModRMs[bytes[1]] - 1);
+    reference.DisplacementOffset = 2;
+    reference.Length = 6;
+    break;
+
+  case LeadRexW:
+    if (available < 7 || !RexWOpcodes[bytes[1]] || !isRipRelative(bytes[2])) {
+      return std::nullopt;
+    }
+    reference.Kind = static_cast<RipReferenceKind>(RexWOpcodes[bytes[1]] - 1);
+    reference.DisplacementOffset = 3;
+    reference.Length = 7;
+    break;
+
+  default:
+    return std::nullopt;
+  }
+
+  std::int32_t displacement;
+  std::memcpy(&displacement, bytes + reference.DisplacementOffset,
+              sizeof(displacement));
+
+  reference.SiteRVA = static_cast<std::uint32_t>(offset);
+  reference.TargetRVA = static_cast<std::uint32_t>(
+      offset + reference.Length + static_cast<std::int64_t>(displacement));
+
+  return reference;
+}
+
+// calls fn(offset) for every byte of the code that is a lead byte.
+template <typename Fn>
+void forEachLeadByte(const std::span<const std::uint8_t> code, Fn &&fn) {
+  std::size_t offset = 0;
+
+#if defined(_M_X64) || defined(__x86_64__)
+  // 16 bytes per iteration against FF and 48-4F, most code has few of
+  // either.
+  const __m128i groupFF = _mm_set1_epi8(static_cast<char>(0xff));
+  const __m128i rexMask = _mm_set1_epi8(static_cast<char>(0xf8));
+  const __m128i rexW = _mm_set1_epi8(0x48);
+
+  for (; offset + 16 <= code.size(); offset += 16) {
+    const __m128i bytes = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(code.data() + offset));
+
+    const __m128i leads =
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, groupFF),
+                     _mm_cmpeq_epi8(_mm_and_si128(bytes, rexMask), rexW));
+
+    for (auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(leads));
+         mask != 0; mask &= mask - 1) {
+      fn(offset + std::countr_zero(mask));
+    }
+  }
+#endif
+
+  for (; offset < code.size(); offset++) {
+    if (LeadBytes[code[offset]] != NoLead) {
+      fn(offset);
+    }
+  }
+}
+} // namespace
+
+void RipReferenceIndex::addCode(const std::span<const std::uint8_t> code,
+                                const std::uint32_t codeRVA) {
+
+  forEachLeadByte(code, [&](const std::size_t offset) {
+    if (auto reference = decode(code, offset)) {
+      reference->SiteRVA += codeRVA;
+      reference->TargetRVA += codeRVA;
+      references.push_back(*reference);
+    }
+  });
+
+  std::ranges::sort(references, {}, [](const RipReference &reference) {
+    return std::pair(reference.TargetRVA, reference.SiteRVA);
+  });
+}
+
+std::span<const RipReference>
+RipReferenceIndex::find(const std::uint32_t targetRVA) const {
+  const auto [first, last] = std::ranges::equal_range(
+      references, targetRVA, {}, &RipReference::TargetRVA);
+  return {first, last};
+}
+
+std::size_t RipReferenceIndex::getSize() const { return references.size(); }
+} // namespace dmadump
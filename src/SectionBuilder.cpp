@@ -1,16 +1,24 @@
 #include <dmadump/SectionBuilder.hpp>
 #include <dmadump/Utils.hpp>
+#include <algorithm>
+#include <cstring>
 
 namespace dmadump {
 SectionBuilder::SectionBuilder(const std::uint32_t sectionOffset,
                                const std::uint32_t sectionRVA,
                                const std::uint32_t sectionAlignment,
-                               const std::uint32_t fileAlignment)
+                               const std::uint32_t fileAlignment,
+                               const std::span<std::uint8_t> storage)
     : sectionOffset(sectionOffset), sectionRVA(sectionRVA),
       sectionAlignment(sectionAlignment), fileAlignment(fileAlignment),
-      characteristics(0) {}
+      characteristics(0), storage(storage), size(0) {}
 
-void SectionBuilder::finalize() { data.resize(getFileSize()); }
+void SectionBuilder::finalize() {
+  const auto padding =
+      storage.subspan(size).first(std::min<std::size_t>(
+          getFileSize() - size, storage.size() - size));
+  std::ranges::fill(padding, 0);
+}
 
 std::uint32_t SectionBuilder::getOffset() const { return sectionOffset; }
 
@@ -22,26 +30,46 @@ std::uint32_t SectionBuilder::getSectionAlignment() const {
 
 std::uint32_t SectionBuilder::getFileAlignment() const { return fileAlignment; }
 
-const std::vector<std::uint8_t> &SectionBuilder::getData() const {
-  return data;
+std::span<const std::uint8_t> SectionBuilder::getData() const {
+  return storage.first(size);
+}
+
+std::span<std::uint8_t> SectionBuilder::getMutableData() {
+  return storage.first(size);
+}
+
+std::uint8_t *SectionBuilder::reserve(const std::size_t size) {
+  if (size > storage.size() - this->size) {
+    return nullptr;
+  }
+
+  const auto reserved = storage.data() + this->size;
+  this->size += size;
+
+  return reserved;
 }
 
-std::vector<std::uint8_t> &SectionBuilder::getMutableData() { return data; }
+bool SectionBuilder::append(const std::uint8_t *buffer,
+                            const std::size_t size) {
+  const auto reserved = reserve(size);
+  if (!reserved) {
+    return false;
+  }
 
-void SectionBuilder::append(const std::uint8_t *buffer, std::size_t size) {
-  data.insert(data.end(), buffer, buffer + size);
+  std::memcpy(reserved, buffer, size);
+  return true;
 }
 
 std::uint32_t SectionBuilder::getRawSize() const {
-  return static_cast<std::uint32_t>(data.size());
+  return static_cast<std::uint32_t>(size);
 }
 
 std::uint32_t SectionBuilder::getVirtualSize() const {
-  return align<std::uint32_t>(data.size(), sectionAlignment);
+  return align<std::uint32_t>(size, sectionAlignment);
 }
 
 std::uint32_t SectionBuilder::getFileSize() const {
-  return align<std::uint32_t>(data.size(), fileAlignment);
+  return align<std::uint32_t>(size, fileAlignment);
 }
 
 std::uint32_t SectionBuilder::getCharacteristics() const {
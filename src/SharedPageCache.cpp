@@ -0,0 +1,110 @@
+#include <dmadump/SharedPageCache.hpp>
+#include <algorithm>
+
+namespace dmadump {
+SharedPageCache::Shard::Shard(const std::size_t capacity) : Cache(capacity) {}
+
+SharedPageCache::SharedPageCache(const std::size_t capacity)
+    : capacity(capacity) {
+  for (auto &shard : shards) {
+    shard = std::make_unique<Shard>(capacity / ShardCount);
+  }
+}
+
+bool SharedPageCache::read(const std::uint64_t pageVA,
+                           const std::uint32_t offset,
+                           const std::uint32_t size, void *buffer) {
+  auto &shard = getShard(pageVA);
+  std::lock_guard lock(shard.Mutex);
+
+  const std::uint8_t *cached = shard.Cache.find(pageVA);
+  if (!cached) {
+    return false;
+  }
+
+  std::copy_n(cached + offset, size, static_cast<std::uint8_t *>(buffer));
+  return true;
+}
+
+bool SharedPageCache::contains(const std::uint64_t pageVA) const {
+  auto &shard = getShard(pageVA);
+  std::lock_guard lock(shard.Mutex);
+
+  return shard.Cache.contains(pageVA);
+}
+
+SharedPageCache::Claim SharedPageCache::claim(const std::uint64_t pageVA,
+                                              const bool forceUpdate) {
+  auto &shard = getShard(pageVA);
+  std::lock_guard lock(shard.Mutex);
+
+  if (const auto found = shard.Pending.find(pageVA);
+      found != shard.Pending.end()) {
+    return {false, found->second.Future};
+  }
+
+  if (!forceUpdate && shard.Cache.contains(pageVA)) {
+    return {false, {}};
+  }
+
+  auto &inFlight = shard.Pending[pageVA];
+  inFlight.Future = inFlight.Promise.get_future().share();
+
+  return {true, {}};
+}
+
+void SharedPageCache::publish(const std::uint64_t pageVA,
+                              const std::uint8_t *data) {
+  auto &shard = getShard(pageVA);
+
+  std::promise<bool> promise;
+  {
+    std::lock_guard lock(shard.Mutex);
+
+    if (data) {
+      if (const auto frame = shard.Cache.insert(pageVA)) {
+        std::copy_n(data, PageCache::PageSize, frame);
+      }
+    }
+
+    const auto found = shard.Pending.find(pageVA);
+    if (found == shard.Pending.end()) {
+      return;
+    }
+
+    promise = std::move(found->second.Promise);
+    shard.Pending.erase(found);
+  }
+
+  promise.set_value(data != nullptr);
+}
+
+void SharedPageCache::clear() {
+  for (const auto &shard : shards) {
+    std::lock_guard lock(shard->Mutex);
+    shard->Cache.clear();
+  }
+}
+
+std::size_t SharedPageCache::getCapacity() const { return capacity; }
+
+PageCache::Statistics SharedPageCache::getStatistics() const {
+  PageCache::Statistics statistics{};
+
+  for (const auto &shard : shards) {
+    std::lock_guard lock(shard->Mutex);
+
+    const auto &shardStatistics = shard->Cache.getStatistics();
+    statistics.Hits += shardStatistics.Hits;
+    statistics.Misses += shardStatistics.Misses;
+    statistics.Evictions += shardStatistics.Evictions;
+  }
+
+  return statistics;
+}
+
+SharedPageCache::Shard &
+SharedPageCache::getShard(const std::uint64_t pageVA) const {
+  return *shards[(pageVA / PageCache::PageSize) % ShardCount];
+}
+} // namespace dmadump
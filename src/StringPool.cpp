@@ -0,0 +1,75 @@
+#include <dmadump/StringPool.hpp>
+#include <algorithm>
+#include <mutex>
+
+namespace dmadump {
+InternedString::InternedString(const std::string_view str)
+    : InternedString(StringPool::get().intern(str)) {}
+
+StringPool &StringPool::get() {
+  static StringPool pool;
+  return pool;
+}
+
+InternedString StringPool::intern(const std::string_view str) {
+  InternedString result;
+  if (str.empty()) {
+    return result;
+  }
+
+  {
+    std::shared_lock lock(mutex);
+    if (const auto found = strings.find(str); found != strings.end()) {
+      result.str = *found;
+      return result;
+    }
+  }
+
+  std::unique_lock lock(mutex);
+  if (const auto found = strings.find(str); found != strings.end()) {
+    result.str = *found;
+    return result;
+  }
+
+  result.str = *strings.insert(allocate(str)).first;
+  return result;
+}
+
+std::size_t StringPool::getCount() const {
+  std::shared_lock lock(mutex);
+  return strings.size();
+}
+
+std::size_t StringPool::getArenaSize() const {
+  std::shared_lock lock(mutex);
+  return arenaSize;
+}
+
+std::string_view StringPool::allocate(const std::string_view str) {
+  const std::size_t size = str.size() + sizeof('\0');
+
+  char *data;
+  if (size > BlockSize / 4) {
+    // large strings get a block of their own so that the current block is not
+    // abandoned half empty.
+    data = largeBlocks
+               .emplace_back(std::make_unique_for_overwrite<char[]>(size))
+               .get();
+    arenaSize += size;
+  } else {
+    if (blockUsed + size > BlockSize) {
+      blocks.push_back(std::make_unique_for_overwrite<char[]>(BlockSize));
+      blockUsed = 0;
+      arenaSize += BlockSize;
+    }
+
+    data = blocks.back().get() + blockUsed;
+    blockUsed += size;
+  }
+
+  std::copy_n(str.data(), str.size(), data);
+  data[str.size()] = '\0';
+
+  return {data, str.size()};
+}
+} // namespace dmadump